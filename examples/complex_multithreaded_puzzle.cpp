@@ -11,7 +11,7 @@ std::mutex cout_mutex;
 std::atomic<int> global_counter(0);
 
 void sleepy_function(int ms) {
-    CTRACK;
+    CTRACK_WAIT;
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include "ctrack.hpp"
+
+void busy_wait(int ms) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+void prepare() {
+    CTRACK;
+    busy_wait(5);
+}
+
+void process_chunk(int ms) {
+    CTRACK;
+    busy_wait(ms);
+}
+
+void merge_results() {
+    CTRACK;
+    busy_wait(3);
+}
+
+void run_frame() {
+    CTRACK;
+    prepare();
+
+    // Link the worker spans to this span so the critical path can follow them
+    auto fork = ctrack::mark_fork();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+        workers.emplace_back([fork, i] {
+            CTRACK_FORKED(fork);
+            process_chunk(2 + i * 4); // the last worker is the straggler
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    merge_results();
+}
+
+int main() {
+    for (int i = 0; i < 10; ++i) {
+        run_frame();
+    }
+
+    ctrack::ctrack_result_settings settings;
+    settings.critical_path = true;
+    ctrack::result_print(settings);
+
+    return 0;
+}
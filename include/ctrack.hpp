@@ -10,7 +10,9 @@
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstdint>
 #include <deque>
 #include <map>
@@ -26,6 +28,50 @@
 #include <sstream>
 #include <atomic>
 #include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+#include <tuple>
+#include <random>
+#include <utility>
+#include <type_traits>
+#if defined(CTRACK_ENABLE_PERF_COUNTERS) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CTRACK_HAS_PERF_COUNTERS
+#endif
+#if defined(CTRACK_ENABLE_RUSAGE) && defined(__linux__)
+#define CTRACK_HAS_RUSAGE
+#include <sys/resource.h>
+#ifndef CTRACK_RUSAGE_MIN_DURATION_NS
+#define CTRACK_RUSAGE_MIN_DURATION_NS 0 //spans shorter than this skip the second getrusage call and are not reported
+#endif
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+#include <cstdlib>
+#include <new>
+#endif
+#if defined(_WIN32) && (defined(CTRACK_ENABLE_CPU_TIME) || defined(CTRACK_ENABLE_CPU_TRACKING))
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+#if defined(CTRACK_ENABLE_CPU_TIME) && !defined(_WIN32)
+#include <time.h>
+#endif
+#if defined(CTRACK_ENABLE_CPU_TRACKING) && defined(__linux__)
+#include <sched.h>
+#endif
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#define CTRACK_HAS_COROUTINES
+#endif
+#endif
 
 #define CTRACK_VERSION_MAJOR 1
 #define CTRACK_VERSION_MINOR 0
@@ -50,8 +96,11 @@ namespace ctrack {
 #ifndef CTRACK_DISABLE_EXECUTION_POLICY
 		constexpr auto execution_policy = std::execution::par_unseq;
 #define OPT_EXEC_POLICY execution_policy,
+		constexpr auto parallel_execution_policy = std::execution::par;
+#define OPT_PAR_EXEC_POLICY parallel_execution_policy,
 #else
 #define OPT_EXEC_POLICY
+#define OPT_PAR_EXEC_POLICY
 #endif
 
 		template<typename T, typename Field>
@@ -134,6 +183,59 @@ namespace ctrack {
 			);
 		}
 
+		//requires ascending sorted values, q between 0-1, linear interpolation between closest ranks
+		template <typename T>
+		double sorted_quantile(const std::vector<T>& sorted_values, double q) {
+			if (sorted_values.size() == 0)
+				return 0.0;
+			const double pos = std::clamp(q, 0.0, 1.0) * static_cast<double>(sorted_values.size() - 1);
+			const size_t lower = static_cast<size_t>(pos);
+			const size_t upper = std::min(lower + 1, sorted_values.size() - 1);
+			const double frac = pos - static_cast<double>(lower);
+			return static_cast<double>(sorted_values[lower]) * (1.0 - frac) + static_cast<double>(sorted_values[upper]) * frac;
+		}
+
+		//two-sided Mann-Whitney U test (normal approximation with tie correction), requires both inputs sorted ascending
+		template <typename T>
+		double mann_whitney_p_value(const std::vector<T>& a, const std::vector<T>& b) {
+			const double n1 = static_cast<double>(a.size());
+			const double n2 = static_cast<double>(b.size());
+			if (a.size() < 2 || b.size() < 2)
+				return 1.0;
+
+			double rank_sum_a = 0.0;
+			double tie_sum = 0.0;
+			size_t i = 0, j = 0;
+			double rank = 1.0;
+			while (i < a.size() || j < b.size()) {
+				const T value = (j >= b.size() || (i < a.size() && a[i] <= b[j])) ? a[i] : b[j];
+				size_t cnt_a = 0, cnt_b = 0;
+				while (i < a.size() && a[i] == value) { i++; cnt_a++; }
+				while (j < b.size() && b[j] == value) { j++; cnt_b++; }
+				const double ties = static_cast<double>(cnt_a + cnt_b);
+				const double avg_rank = rank + (ties - 1.0) / 2.0;
+				rank_sum_a += avg_rank * static_cast<double>(cnt_a);
+				tie_sum += ties * ties * ties - ties;
+				rank += ties;
+			}
+
+			const double n = n1 + n2;
+			const double u = rank_sum_a - n1 * (n1 + 1.0) / 2.0;
+			const double mean_u = n1 * n2 / 2.0;
+			const double variance_u = n1 * n2 / 12.0 * ((n + 1.0) - tie_sum / (n * (n - 1.0)));
+			if (variance_u <= 0.0)
+				return 1.0;
+			const double z = (std::abs(u - mean_u) - 0.5) / std::sqrt(variance_u);
+			if (z <= 0.0)
+				return 1.0;
+			return std::erfc(z / std::sqrt(2.0));
+		}
+
+		struct confidence_interval {
+			double lower = 0.0;
+			double upper = 0.0;
+		};
+
 		struct ColorScheme {
 			std::string border_color;
 			std::string header_color;
@@ -170,6 +272,7 @@ namespace ctrack {
 			std::vector<std::pair<std::string, int>> top_header;
 			std::vector<std::string> header;
 			std::vector<std::vector<std::string>> rows;
+			std::vector<std::string> rowColors;
 			std::vector<size_t> columnWidths;
 			bool useColor;
 			ColorScheme colors;
@@ -184,6 +287,27 @@ namespace ctrack {
 						columnWidths[i] = std::max< size_t>(columnWidths[i], row[i].length());
 					}
 				}
+				fitTopHeader();
+			}
+
+			//widens the spanned columns if a top header text is wider than the columns below it
+			void fitTopHeader() {
+				size_t column = 0;
+				for (const auto& [text, span] : top_header) {
+					if (span <= 0 || column + span > columnWidths.size())
+						return;
+					size_t width = span - 1;
+					for (size_t x = column; x < column + span; x++) {
+						width += columnWidths[x] + 2;
+					}
+					if (text.length() > width) {
+						const size_t missing = text.length() - width;
+						for (size_t x = column; x < column + span; x++) {
+							columnWidths[x] += missing / span + (x == column + span - 1 ? missing % span : 0);
+						}
+					}
+					column += span;
+				}
 			}
 
 			template<typename StreamType>
@@ -265,9 +389,15 @@ namespace ctrack {
 					throw std::invalid_argument("Row size must match header size");
 				}
 				rows.push_back(row);
+				rowColors.emplace_back();
 				updateColumnWidths(row);
 			}
 
+			void addRow(const std::vector<std::string>& row, const std::string& color) {
+				addRow(row);
+				rowColors.back() = color;
+			}
+
 			template<typename StreamType>
 			void print(StreamType& stream) const {
 				if (top_header.size() > 0) {
@@ -277,8 +407,8 @@ namespace ctrack {
 				printHorizontalLine(stream);
 				printRow(stream, header, colors.header_color, true);
 				printHorizontalLine(stream);
-				for (const auto& row : rows) {
-					printRow(stream, row, colors.row_color);
+				for (size_t i = 0; i < rows.size(); ++i) {
+					printRow(stream, rows[i], rowColors[i].empty() ? colors.row_color : rowColors[i]);
 					printHorizontalLine(stream);
 				}
 			}
@@ -322,6 +452,35 @@ namespace ctrack {
 				return ss.str();
 			}
 
+			static inline std::string table_quantity(double value) {
+				const char* units[] = { "", "k", "M", "G", "T" };
+				int unit = 0;
+				while (std::abs(value) >= 1000 && unit < 4) {
+					value /= 1000;
+					unit++;
+				}
+				std::ostringstream oss;
+				oss << std::fixed << std::setprecision(unit == 0 && value == std::floor(value) ? 0 : 2) << value << units[unit];
+				return oss.str();
+			}
+
+			static inline std::string table_interval(const confidence_interval& interval) {
+				return table_time(interval.lower) + " - " + table_time(interval.upper);
+			}
+
+			static inline std::string table_signed_time(double nanoseconds) {
+				return (nanoseconds < 0 ? "-" : "+") + table_time(std::abs(nanoseconds));
+			}
+
+			static inline std::string table_change(double current, double baseline) {
+				if (std::fpclassify(baseline) == FP_ZERO) {
+					return "nan%";
+				}
+				std::ostringstream ss;
+				ss << std::showpos << std::fixed << std::setprecision(2) << (current / baseline - 1.0) * 100.0 << "%";
+				return ss.str();
+			}
+
 			static inline std::string table_timepoint(const std::chrono::high_resolution_clock::time_point& tp) {
 				auto system_tp = std::chrono::system_clock::now() +
 					std::chrono::duration_cast<std::chrono::system_clock::duration>(
@@ -358,6 +517,19 @@ namespace ctrack {
 			using  bt = BeautifulTable;
 		};
 
+		enum class event_kind : uint8_t {
+			span = 0,
+			parallel_region = 1, //coordinating span of a parallel region, see CTRACK_PARALLEL_REGION
+			coroutine = 2, //body of a coroutine, see CTRACK_CORO; start to end including suspensions
+			batch = 3, //span processing several items, see CTRACK_BATCH
+			wait = 4, //sleeping or blocked, see CTRACK_WAIT; reported separately and not counted as active work
+			frame = 5, //root span of a request or frame, see CTRACK_FRAME
+		};
+
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+		inline constexpr uint16_t unknown_cpu = 0xFFFF;
+#endif
+
 		struct Event {
 			std::chrono::high_resolution_clock::time_point start_time;
 			std::chrono::high_resolution_clock::time_point end_time;
@@ -366,8 +538,34 @@ namespace ctrack {
 			std::string_view filename;
 			std::string_view function;
 			unsigned int event_id;
-			Event(const std::chrono::high_resolution_clock::time_point& start_time, const std::chrono::high_resolution_clock::time_point& end_time, const std::string_view filename, const  int line, const std::string_view function, const int thread_id, const unsigned int event_id)
-				: start_time(start_time), end_time(end_time), line(line), thread_id(thread_id), filename(filename), function(function), event_id(event_id)
+			event_kind kind;
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			uint16_t start_cpu = unknown_cpu; //cpu the span started and ended on
+			uint16_t end_cpu = unknown_cpu;
+#endif
+#ifdef CTRACK_HAS_PERF_COUNTERS
+			uint8_t counter_mask = 0; //bit i set: counters[i] is valid
+			uint64_t counters[4] = {}; //cycles, instructions, LLC misses, branch misses during the span
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+			bool has_allocations = false;
+			uint64_t allocations = 0; //operator new calls of the thread during the span
+			uint64_t allocated_bytes = 0;
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+			bool has_rusage = false;
+			uint32_t minor_faults = 0;
+			uint32_t major_faults = 0;
+			uint32_t voluntary_switches = 0;
+			uint32_t involuntary_switches = 0;
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+			bool has_cpu_time = false;
+			uint64_t cpu_time = 0; //ns the thread was running during the span
+			uint64_t cpu_wall_time = 0; //ns of wall time between the two cpu time samples
+#endif
+			Event(const std::chrono::high_resolution_clock::time_point& start_time, const std::chrono::high_resolution_clock::time_point& end_time, const std::string_view filename, const  int line, const std::string_view function, const int thread_id, const unsigned int event_id, const event_kind kind = event_kind::span)
+				: start_time(start_time), end_time(end_time), line(line), thread_id(thread_id), filename(filename), function(function), event_id(event_id), kind(kind)
 			{}
 		};
 
@@ -455,9 +653,12 @@ namespace ctrack {
 			return result;
 		}
 
+		//children linked from other threads (see ctrack::adopt) are clipped to the parent, as they may outlive it
 		inline std::vector<Simple_Event> load_child_events_simple(const std::vector<Simple_Event>& parent_events_simple,
-			const std::unordered_map < int_fast64_t, Event>& events_map, const  std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& child_graph) {
+			const std::unordered_map < int_fast64_t, Event>& events_map, const  std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& child_graph,
+			const std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& cross_child_graph) {
 			std::vector<const Event*> child_events{};
+			std::vector<Simple_Event> cross_child_events{};
 
 			//std::set< int_fast64_t> parent_ids = get_distinct_field_values(parent_events_simple, &Simple_Event::unique_id);
 			for (const auto& simple_parent_event : parent_events_simple)
@@ -475,16 +676,561 @@ namespace ctrack {
 						child_events.push_back(&child_event);
 					}
 				}
+				//linked children on the parent's own thread (e.g. inside a coroutine) are nested like normal children. Work on
+				//other threads runs next to the parent and does not reduce its exclusive time, see load_forked_time
+				auto cross_it = cross_child_graph.find(simple_parent_event.unique_id);
+				if (cross_it != cross_child_graph.end()) {
+					for (auto& child_id : cross_it->second) {
+						auto& child_event = events_map.at(child_id);
+						auto& parent_event = events_map.at(simple_parent_event.unique_id);
+						if (child_event.thread_id != parent_event.thread_id)
+							continue;
+						if (child_event.filename == parent_event.filename &&
+							child_event.function == parent_event.function &&
+							child_event.line == parent_event.line)
+							continue;
+
+						const auto start = std::max(child_event.start_time, simple_parent_event.start_time);
+						const auto end = std::min(child_event.end_time, simple_parent_event.end_time);
+						if (end > start)
+							cross_child_events.emplace_back(start, end, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), child_id);
+					}
+				}
+			}
+
+			auto child_events_simple = create_simple_events(child_events);
+			child_events_simple.insert(child_events_simple.end(), cross_child_events.begin(), cross_child_events.end());
+			return child_events_simple;
+		};
+
+		//time the parents' forked and adopted children ran on other threads, clipped to each parent and merged per parent
+		inline uint_fast64_t load_forked_time(const std::vector<Simple_Event>& parent_events_simple,
+			const std::unordered_map < int_fast64_t, Event>& events_map, const std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& cross_child_graph) {
+			uint_fast64_t res = 0;
+			for (const auto& simple_parent_event : parent_events_simple) {
+				auto cross_it = cross_child_graph.find(simple_parent_event.unique_id);
+				if (cross_it == cross_child_graph.end())
+					continue;
+				const int parent_thread = events_map.at(simple_parent_event.unique_id).thread_id;
+				std::vector<Simple_Event> forked{};
+				for (auto& child_id : cross_it->second) {
+					auto& child_event = events_map.at(child_id);
+					const auto start = std::max(child_event.start_time, simple_parent_event.start_time);
+					const auto end = std::min(child_event.end_time, simple_parent_event.end_time);
+					if (child_event.thread_id != parent_thread && end > start)
+						forked.emplace_back(start, end, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), child_id);
+				}
+				std::sort(forked.begin(), forked.end(), cmp_simple_event_by_start_time_asc);
+				res += sum_field(sorted_create_grouped_simple_events(forked), &Simple_Event::duration);
+			}
+			return res;
+		}
+
+		struct ctrack_result_settings {
+			unsigned int non_center_percent = 1;
+			double min_percent_active_exclusive = 0.0; //between 0-100
+			double percent_exclude_fastest_active_exclusive = 0.0; //between 0-100
+
+			unsigned int bootstrap_resamples = 0; //0 disables confidence intervals
+			double bootstrap_confidence = 95.0; //between 0-100
+			size_t bootstrap_max_samples = 10000; //larger callsites are reservoir sampled down to this size
+			std::vector<double> bootstrap_quantiles = { 90.0, 99.0 }; //between 0-100
+
+			bool detect_change_points = false;
+			double change_point_penalty = 0.0; //0 uses 3 * ln(calls)
+			unsigned int change_point_min_segment = 30; //minimum calls between two change points
+			unsigned int change_point_max = 8; //maximum change points per callsite
+			double change_point_min_change = 10.0; //minimum relative shift in percent, filters slow drifts
+
+			unsigned int heatmap_time_buckets = 0; //0 disables latency heatmaps
+			unsigned int heatmap_duration_buckets = 12; //log scaled between fastest and slowest call
+
+			bool critical_path = false;
+			unsigned int critical_path_max_segments = 40; //printed segments of the longest critical path
+
+			bool amdahl_analysis = false;
+			unsigned int amdahl_max_cores = 64; //projected speedups for 2, 4, ... up to this many cores
+
+			unsigned int overlap_top_n = 0; //0 disables the callsite overlap matrix
+
+			bool concurrency_scaling = false; //latency per number of threads concurrently inside the same callsite
+
+			unsigned int migration_outliers = 20; //slowest spans that changed cpu, only with CTRACK_ENABLE_CPU_TRACKING
+			double frame_slow_percentile = 95.0; //CTRACK_FRAME spans at or above this percentile of their duration are slow frames
+
+			double straggler_percent = 10.0; //workers slower than the region mean by more than this are stragglers
+		};
+
+		struct bootstrap_result {
+			confidence_interval mean{};
+			confidence_interval med{};
+			std::vector<confidence_interval> quantiles{}; //same order as ctrack_result_settings::bootstrap_quantiles
+		};
+
+		//requires events sorted by duration
+		inline bootstrap_result bootstrap_confidence_intervals(const std::vector<Simple_Event>& events, const ctrack_result_settings& settings) {
+			bootstrap_result res{};
+			const size_t quantile_cnt = settings.bootstrap_quantiles.size();
+			res.quantiles.resize(quantile_cnt);
+			if (events.size() == 0 || settings.bootstrap_resamples == 0)
+				return res;
+
+			std::vector<double> sample{};
+			const size_t sample_size = std::min(events.size(), std::max<size_t>(settings.bootstrap_max_samples, 1));
+			sample.reserve(sample_size);
+			std::mt19937_64 reservoir_gen(events.size());
+			for (size_t i = 0; i < events.size(); i++) {
+				if (i < sample_size) {
+					sample.push_back(static_cast<double>(events[i].duration));
+				}
+				else {
+					const size_t j = std::uniform_int_distribution<size_t>(0, i)(reservoir_gen);
+					if (j < sample_size)
+						sample[j] = static_cast<double>(events[i].duration);
+				}
+			}
+
+			const size_t resamples = settings.bootstrap_resamples;
+			std::vector<double> means(resamples), meds(resamples), quantiles(resamples * quantile_cnt);
+			std::vector<size_t> resample_ids(resamples);
+			std::iota(resample_ids.begin(), resample_ids.end(), size_t(0));
+			std::for_each(OPT_PAR_EXEC_POLICY resample_ids.begin(), resample_ids.end(), [&](size_t r) {
+				std::mt19937_64 gen(r * 0x9E3779B97F4A7C15ull + sample_size);
+				std::uniform_int_distribution<size_t> pick(0, sample_size - 1);
+				std::vector<double> resample(sample_size);
+				for (auto& value : resample)
+					value = sample[pick(gen)];
+				std::sort(resample.begin(), resample.end());
+				means[r] = std::accumulate(resample.begin(), resample.end(), 0.0) / static_cast<double>(sample_size);
+				meds[r] = sorted_quantile(resample, 0.5);
+				for (size_t q = 0; q < quantile_cnt; q++)
+					quantiles[r * quantile_cnt + q] = sorted_quantile(resample, settings.bootstrap_quantiles[q] / 100.0);
+				});
+
+			const double alpha = (1.0 - std::clamp(settings.bootstrap_confidence, 0.0, 100.0) / 100.0) / 2.0;
+			auto percentile_interval = [alpha](std::vector<double>& values) {
+				std::sort(values.begin(), values.end());
+				return confidence_interval{ sorted_quantile(values, alpha), sorted_quantile(values, 1.0 - alpha) };
+				};
+			res.mean = percentile_interval(means);
+			res.med = percentile_interval(meds);
+			std::vector<double> quantile_values(resamples);
+			for (size_t q = 0; q < quantile_cnt; q++) {
+				for (size_t r = 0; r < resamples; r++)
+					quantile_values[r] = quantiles[r * quantile_cnt + q];
+				res.quantiles[q] = percentile_interval(quantile_values);
+			}
+			return res;
+		}
+
+		struct change_point {
+			std::chrono::high_resolution_clock::time_point time{}; //start time of the first call after the shift
+			size_t calls_before = 0;
+			double mean_before = 0.0; //mean duration of the segment before the shift
+			double mean_after = 0.0; //mean duration of the segment after the shift
+			double magnitude = 0.0; //mean_after - mean_before in ns
+		};
+
+		//offline binary segmentation for shifts in the mean of the log durations, requires events sorted by start time.
+		//log durations keep the heavy latency tail from being detected as a shift, the noise level is estimated
+		//from successive differences so existing shifts do not inflate it
+		inline std::vector<change_point> detect_change_points(const std::vector<Simple_Event>& events, const ctrack_result_settings& settings) {
+			std::vector<change_point> res{};
+			const size_t n = events.size();
+			const size_t min_segment = std::max<size_t>(settings.change_point_min_segment, 2);
+			if (n < 2 * min_segment || settings.change_point_max == 0)
+				return res;
+
+			std::vector<double> prefix(n + 1, 0.0), raw_prefix(n + 1, 0.0), diffs(n - 1);
+			for (size_t i = 0; i < n; i++) {
+				prefix[i + 1] = prefix[i] + std::log1p(static_cast<double>(events[i].duration));
+				raw_prefix[i + 1] = raw_prefix[i] + static_cast<double>(events[i].duration);
+			}
+			for (size_t i = 1; i < n; i++)
+				diffs[i - 1] = std::log1p(static_cast<double>(events[i].duration)) - std::log1p(static_cast<double>(events[i - 1].duration));
+
+			auto median = [](std::vector<double>& values) {
+				std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+				return values[values.size() / 2];
+				};
+			const double diff_med = median(diffs);
+			for (auto& d : diffs)
+				d = std::abs(d - diff_med);
+			const double sigma = std::max(1.4826 * median(diffs) / std::sqrt(2.0), 1e-3);
+			const double penalty = settings.change_point_penalty > 0.0 ? settings.change_point_penalty : 3.0 * std::log(static_cast<double>(n));
+			const double min_shift = std::log1p(std::max(settings.change_point_min_change, 0.0) / 100.0);
+
+			//gain of splitting [a,b) at k: reduction of the residual sum of squares in units of the noise variance
+			auto best_split = [&](size_t a, size_t b) {
+				std::pair<double, size_t> best{ 0.0, 0 };
+				const double total = prefix[b] - prefix[a];
+				const double n_total = static_cast<double>(b - a);
+				for (size_t k = a + min_segment; k + min_segment <= b; k++) {
+					const double left = prefix[k] - prefix[a];
+					const double n_left = static_cast<double>(k - a);
+					const double right = total - left;
+					if (std::abs(left / n_left - right / (n_total - n_left)) < min_shift)
+						continue;
+					const double gain = (left * left / n_left + right * right / (n_total - n_left) - total * total / n_total) / (sigma * sigma);
+					if (gain > best.first)
+						best = { gain, k };
+				}
+				return best;
+				};
+
+			std::vector<size_t> splits{ 0, n };
+			while (splits.size() - 2 < settings.change_point_max) {
+				std::pair<double, size_t> best{ 0.0, 0 };
+				for (size_t i = 0; i + 1 < splits.size(); i++) {
+					auto candidate = best_split(splits[i], splits[i + 1]);
+					if (candidate.first > best.first)
+						best = candidate;
+				}
+				if (best.first <= penalty)
+					break;
+				splits.insert(std::upper_bound(splits.begin(), splits.end(), best.second), best.second);
+			}
+
+			for (size_t i = 1; i + 1 < splits.size(); i++) {
+				change_point cp{};
+				cp.time = events[splits[i]].start_time;
+				cp.calls_before = splits[i];
+				cp.mean_before = (raw_prefix[splits[i]] - raw_prefix[splits[i - 1]]) / static_cast<double>(splits[i] - splits[i - 1]);
+				cp.mean_after = (raw_prefix[splits[i + 1]] - raw_prefix[splits[i]]) / static_cast<double>(splits[i + 1] - splits[i]);
+				cp.magnitude = cp.mean_after - cp.mean_before;
+				res.push_back(cp);
+			}
+			return res;
+		}
+
+		struct latency_heatmap {
+			std::chrono::high_resolution_clock::time_point start_time{}, end_time{}; //start times of the first and last call
+			uint_fast64_t min_duration = 0, max_duration = 0;
+			unsigned int time_buckets = 0, duration_buckets = 0;
+			std::vector<unsigned int> counts = {}; //duration_bucket * time_buckets + time_bucket
+
+			unsigned int count(unsigned int time_bucket, unsigned int duration_bucket) const {
+				return counts[duration_bucket * time_buckets + time_bucket];
+			}
+
+			//lower edge of a log scaled duration bucket, duration_bucket == duration_buckets gives the upper edge of the last bucket
+			double duration_edge(unsigned int duration_bucket) const {
+				const double lo = static_cast<double>(std::max<uint_fast64_t>(min_duration, 1));
+				const double hi = static_cast<double>(max_duration + 1);
+				return lo * std::pow(hi / lo, static_cast<double>(duration_bucket) / duration_buckets);
+			}
+
+			std::chrono::high_resolution_clock::time_point time_edge(unsigned int time_bucket) const {
+				return start_time + (end_time - start_time) * time_bucket / time_buckets;
+			}
+		};
+
+		inline latency_heatmap create_latency_heatmap(const std::vector<Simple_Event>& events, unsigned int time_buckets, unsigned int duration_buckets) {
+			latency_heatmap res{};
+			if (events.size() == 0 || time_buckets == 0 || duration_buckets == 0)
+				return res;
+			res.time_buckets = time_buckets;
+			res.duration_buckets = duration_buckets;
+			res.counts.resize(static_cast<size_t>(time_buckets) * duration_buckets, 0);
+			auto [min_start, max_start] = std::minmax_element(events.begin(), events.end(), cmp_simple_event_by_start_time_asc);
+			auto [min_duration, max_duration] = std::minmax_element(events.begin(), events.end(), cmp_simple_event_by_duration_asc);
+			res.start_time = min_start->start_time;
+			res.end_time = max_start->start_time;
+			res.min_duration = min_duration->duration;
+			res.max_duration = max_duration->duration;
+
+			const double time_span = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(res.end_time - res.start_time).count()) + 1.0;
+			const double log_lo = std::log(static_cast<double>(std::max<uint_fast64_t>(res.min_duration, 1)));
+			const double log_span = std::log(static_cast<double>(res.max_duration + 1)) - log_lo;
+			for (const auto& e : events) {
+				const double offset = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(e.start_time - res.start_time).count());
+				const unsigned int t = std::min(time_buckets - 1, static_cast<unsigned int>(offset / time_span * time_buckets));
+				const double log_duration = std::log(static_cast<double>(std::max<uint_fast64_t>(e.duration, 1))) - log_lo;
+				const unsigned int d = log_span > 0.0 ? std::min(duration_buckets - 1, static_cast<unsigned int>(std::max(log_duration, 0.0) / log_span * duration_buckets)) : 0;
+				res.counts[d * time_buckets + t]++;
+			}
+			return res;
+		}
+
+		struct concurrency_level {
+			unsigned int level = 0; //threads inside the callsite during the call, time weighted mean rounded, including the caller
+			unsigned int cnt = 0;
+			double mean = 0.0;
+			double p99 = 0.0;
+		};
+
+		//mean latency ~ intercept + slope * level, fitted over the level means weighted by their call count
+		struct concurrency_scaling {
+			std::vector<concurrency_level> levels = {};
+			double intercept = 0.0;
+			double slope = 0.0; //ns per additional concurrent thread
+			double r_squared = 0.0;
+			//relative slowdown per additional concurrent thread in percent of the single thread latency
+			double contention() const { return intercept + slope > 0.0 ? slope / (intercept + slope) * 100.0 : 0.0; }
+		};
+
+		inline concurrency_scaling create_concurrency_scaling(const std::vector<Event>& events) {
+			concurrency_scaling res{};
+			if (events.size() == 0)
+				return res;
+			//recursion on one thread counts once, so the level is taken from the merged intervals per thread
+			std::map<int, std::vector<Simple_Event>> per_thread{};
+			for (const auto& e : events)
+				per_thread[e.thread_id].emplace_back(e.start_time, e.end_time,
+					std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count(), 0);
+			const auto origin = std::min_element(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.start_time < b.start_time; })->start_time;
+			auto to_ns = [origin](const std::chrono::high_resolution_clock::time_point& t) {
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin).count());
+				};
+			std::vector<uint64_t> starts{}, ends{};
+			for (auto& [t_id, simple] : per_thread) {
+				std::sort(simple.begin(), simple.end(), cmp_simple_event_by_start_time_asc);
+				for (const auto& g : sorted_create_grouped_simple_events(simple)) {
+					starts.push_back(to_ns(g.start_time));
+					ends.push_back(to_ns(g.end_time));
+				}
+			}
+			std::sort(starts.begin(), starts.end());
+			std::sort(ends.begin(), ends.end());
+			//prefix sums wrap around, the differences taken below are exact as long as the true values fit in 64 bit
+			std::vector<uint64_t> start_sums(starts.size() + 1, 0), end_sums(ends.size() + 1, 0);
+			for (size_t i = 0; i < starts.size(); i++) {
+				start_sums[i + 1] = start_sums[i] + starts[i];
+				end_sums[i + 1] = end_sums[i] + ends[i];
+			}
+			//sum over the boundaries t in (a, b) of (b - t)
+			auto tail_sum = [](const std::vector<uint64_t>& times, const std::vector<uint64_t>& sums, uint64_t a, uint64_t b) {
+				const size_t i = std::upper_bound(times.begin(), times.end(), a) - times.begin();
+				const size_t j = std::max(i, static_cast<size_t>(std::lower_bound(times.begin(), times.end(), b) - times.begin()));
+				return static_cast<uint64_t>(j - i) * b - (sums[j] - sums[i]);
+				};
+
+			//the level of a call is the time weighted mean of the threads inside the callsite over [start, end),
+			//a call that starts alone and is joined a moment later counts at the level it mostly ran at
+			std::map<unsigned int, std::vector<uint_fast64_t>> per_level{};
+			for (const auto& e : events) {
+				const uint64_t a = to_ns(e.start_time), b = to_ns(e.end_time);
+				const auto started = std::upper_bound(starts.begin(), starts.end(), a) - starts.begin();
+				const auto ended = std::upper_bound(ends.begin(), ends.end(), a) - ends.begin();
+				double mean_level = static_cast<double>(started - ended);
+				if (b > a) {
+					const double area = static_cast<double>(started - ended) * static_cast<double>(b - a)
+						+ static_cast<double>(tail_sum(starts, start_sums, a, b)) - static_cast<double>(tail_sum(ends, end_sums, a, b));
+					mean_level = area / static_cast<double>(b - a);
+				}
+				const unsigned int level = static_cast<unsigned int>(std::max(std::lround(mean_level), 1l));
+				per_level[level].push_back(b - a);
+			}
+
+			double w_sum = 0.0, x_mean = 0.0, y_mean = 0.0;
+			for (auto& [level, durations] : per_level) {
+				std::sort(durations.begin(), durations.end());
+				concurrency_level l{};
+				l.level = level;
+				l.cnt = static_cast<unsigned int>(durations.size());
+				l.mean = std::accumulate(durations.begin(), durations.end(), 0.0) / static_cast<double>(l.cnt);
+				l.p99 = sorted_quantile(durations, 0.99);
+				res.levels.push_back(l);
+				w_sum += l.cnt;
+				x_mean += static_cast<double>(l.cnt) * l.level;
+				y_mean += l.cnt * l.mean;
+			}
+			x_mean /= w_sum;
+			y_mean /= w_sum;
+			double sxx = 0.0, sxy = 0.0, syy = 0.0;
+			for (const auto& l : res.levels) {
+				sxx += l.cnt * (l.level - x_mean) * (l.level - x_mean);
+				sxy += l.cnt * (l.level - x_mean) * (l.mean - y_mean);
+				syy += l.cnt * (l.mean - y_mean) * (l.mean - y_mean);
+			}
+			if (res.levels.size() < 2 || sxx <= 0.0)
+				return res;
+			res.slope = sxy / sxx;
+			res.intercept = y_mean - res.slope * x_mean;
+			res.r_squared = syy > 0.0 ? sxy * sxy / (sxx * syy) : 1.0;
+			return res;
+		}
+
+		struct arg_bucket {
+			int log2_lower = 0; //arguments in [2^log2_lower, 2^(log2_lower+1)), non_positive_bucket holds arguments <= 0
+			unsigned int cnt = 0;
+			double mean_arg = 0.0;
+			double mean = 0.0;
+			double p99 = 0.0;
+		};
+
+		//latency ~ intercept + coefficient * f(n)
+		struct complexity_fit {
+			std::string model{};
+			double coefficient = 0.0;
+			double intercept = 0.0;
+			double r_squared = 0.0;
+		};
+
+		struct arg_scaling {
+			std::vector<arg_bucket> buckets = {};
+			std::vector<complexity_fit> fits = {}; //best fit first
+		};
+
+		constexpr int non_positive_bucket = std::numeric_limits<int>::min();
+
+		inline arg_scaling create_arg_scaling(std::vector<std::pair<double, uint_fast64_t>>& samples) {
+			arg_scaling res{};
+			if (samples.size() == 0)
+				return res;
+			std::map<int, std::vector<std::pair<double, uint_fast64_t>>> per_bucket{};
+			for (const auto& sample : samples)
+				per_bucket[sample.first > 0.0 ? static_cast<int>(std::floor(std::log2(sample.first))) : non_positive_bucket].push_back(sample);
+			for (auto& [log2_lower, bucket_samples] : per_bucket) {
+				arg_bucket bucket{};
+				bucket.log2_lower = log2_lower;
+				bucket.cnt = static_cast<unsigned int>(bucket_samples.size());
+				std::vector<uint_fast64_t> durations{};
+				for (const auto& [arg, duration] : bucket_samples) {
+					bucket.mean_arg += arg / bucket.cnt;
+					bucket.mean += static_cast<double>(duration) / bucket.cnt;
+					durations.push_back(duration);
+				}
+				std::sort(durations.begin(), durations.end());
+				bucket.p99 = sorted_quantile(durations, 0.99);
+				res.buckets.push_back(bucket);
+			}
+
+			const std::pair<const char*, double(*)(double)> models[] = {
+				{ "n", [](double n) { return n; } },
+				{ "n log n", [](double n) { return n > 1.0 ? n * std::log2(n) : 0.0; } },
+				{ "n^2", [](double n) { return n * n; } },
+			};
+			//sizes <= 0 have no place on the growth models, they only show up in their own bucket
+			std::vector<std::pair<double, uint_fast64_t>> fit_samples{};
+			for (const auto& sample : samples)
+				if (sample.first > 0.0)
+					fit_samples.push_back(sample);
+			if (fit_samples.size() == 0)
+				return res;
+			for (const auto& [name, f] : models) {
+				double x_mean = 0.0, y_mean = 0.0;
+				for (const auto& [arg, duration] : fit_samples) {
+					x_mean += f(arg);
+					y_mean += static_cast<double>(duration);
+				}
+				x_mean /= fit_samples.size();
+				y_mean /= fit_samples.size();
+				double sxx = 0.0, sxy = 0.0, syy = 0.0;
+				for (const auto& [arg, duration] : fit_samples) {
+					const double dx = f(arg) - x_mean, dy = static_cast<double>(duration) - y_mean;
+					sxx += dx * dx;
+					sxy += dx * dy;
+					syy += dy * dy;
+				}
+				if (sxx <= 0.0)
+					continue;
+				complexity_fit fit{};
+				fit.model = name;
+				fit.coefficient = sxy / sxx;
+				fit.intercept = y_mean - fit.coefficient * x_mean;
+				fit.r_squared = syy > 0.0 ? sxy * sxy / (sxx * syy) : 1.0;
+				res.fits.push_back(fit);
+			}
+			std::stable_sort(res.fits.begin(), res.fits.end(), [](const complexity_fit& a, const complexity_fit& b) { return a.r_squared > b.r_squared; });
+			return res;
+		}
+
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+		//numa node of a cpu from sysfs, -1 if unknown
+		inline int cpu_numa_node(uint16_t cpu) {
+#ifdef __linux__
+			std::error_code ec;
+			for (auto it = std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+				const std::string name = it->path().filename().string();
+				if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+					return std::stoi(name.substr(4));
+			}
+#endif
+			(void)cpu;
+			return -1;
+		}
+
+		//numa node of every start cpu in the events, read once per result instead of once per callsite
+		inline std::map<int, int> create_cpu_numa_nodes(const std::unordered_map<int_fast64_t, Event>& events_map) {
+			std::map<int, int> nodes{};
+			for (const auto& [id, e] : events_map) {
+				if (e.start_cpu != unknown_cpu && nodes.find(e.start_cpu) == nodes.end())
+					nodes.insert({ e.start_cpu, cpu_numa_node(e.start_cpu) });
+			}
+			return nodes;
+		}
+
+		struct cpu_latency {
+			int id = -1; //cpu or numa node the spans started on
+			int node = -1; //numa node of the cpu, per cpu entries only
+			unsigned int calls = 0;
+			unsigned int migrated = 0; //spans that ended on a different cpu
+			double mean = 0.0;
+			uint_fast64_t median = 0;
+			uint_fast64_t max = 0;
+		};
+
+		inline std::vector<cpu_latency> create_cpu_latencies(std::map<int, std::vector<std::pair<uint_fast64_t, bool>>>& durations) {
+			std::vector<cpu_latency> res{};
+			for (auto& [id, values] : durations) {
+				std::sort(values.begin(), values.end());
+				cpu_latency latency{};
+				latency.id = id;
+				latency.calls = static_cast<unsigned int>(values.size());
+				for (const auto& [duration, migrated] : values) {
+					latency.mean += static_cast<double>(duration);
+					latency.migrated += migrated ? 1 : 0;
+				}
+				latency.mean /= values.size();
+				latency.median = values[values.size() / 2].first;
+				latency.max = values.back().first;
+				res.push_back(latency);
+			}
+			return res;
+		}
+
+		//spans with a known start and end cpu of a fastest/center/slowest band
+		struct migration_counts {
+			unsigned int calls = 0;
+			unsigned int migrated = 0;
+			void add(const Event& e) {
+				if (e.start_cpu == unknown_cpu || e.end_cpu == unknown_cpu)
+					return;
+				calls++;
+				migrated += e.end_cpu != e.start_cpu ? 1 : 0;
 			}
+		};
+#endif
 
-			return  create_simple_events(child_events);
+#ifdef CTRACK_HAS_RUSAGE
+		struct rusage_counts {
+			unsigned int calls = 0;
+			uint64_t minor_faults = 0;
+			uint64_t major_faults = 0;
+			uint64_t voluntary_switches = 0;
+			uint64_t involuntary_switches = 0;
+			void add(const Event& e) {
+				if (!e.has_rusage)
+					return;
+				calls++;
+				minor_faults += e.minor_faults;
+				major_faults += e.major_faults;
+				voluntary_switches += e.voluntary_switches;
+				involuntary_switches += e.involuntary_switches;
+			}
 		};
+#endif
 
 		class EventGroup {
 		public:
 
-			void calculateStats(unsigned int non_center_percent, const
-				std::unordered_map < int_fast64_t, Event>& events_map, const   std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& child_graph) {
+			void calculateStats(const ctrack_result_settings& settings, const
+				std::unordered_map < int_fast64_t, Event>& events_map, const   std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& child_graph,
+				const std::unordered_map< int_fast64_t, std::vector< int_fast64_t>>& cross_child_graph, const std::map<int, int>& cpu_nodes) {
+#ifndef CTRACK_ENABLE_CPU_TRACKING
+				(void)cpu_nodes;
+#endif
 				if (all_events.size() == 0)
 					return;
 
@@ -493,17 +1239,102 @@ namespace ctrack {
 				all_cnt = static_cast<unsigned int> (all_events_simple.size());
 				const double factor = (1.0 / static_cast<double>(all_cnt));
 
-				auto all_child_events_simple = load_child_events_simple(all_events_simple, events_map, child_graph);
+				auto all_child_events_simple = load_child_events_simple(all_events_simple, events_map, child_graph, cross_child_graph);
+				all_time_forked = load_forked_time(all_events_simple, events_map, cross_child_graph);
 
 				all_time_acc = sum_field(all_events_simple, &Simple_Event::duration);
 
-				const double all_mean = all_time_acc * factor;
+				//per call side tables do not depend on the durations, a callsite of only empty spans keeps them
+				all_thread_cnt = static_cast<unsigned int>(count_distinct_field_values(all_events, &Event::thread_id));
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+				//children on the same thread allocated from the same thread counters, forked work counts on its own thread
+				for (const auto& e : all_events) {
+					if (!e.has_allocations)
+						continue;
+					allocation_calls++;
+					allocations_inclusive += e.allocations;
+					allocated_bytes_inclusive += e.allocated_bytes;
+					uint64_t child_allocations = 0, child_bytes = 0;
+					auto children = child_graph.find(static_cast<int_fast64_t>(get_unique_event_id(e.thread_id, e.event_id)));
+					if (children != child_graph.end()) {
+						for (auto child_id : children->second) {
+							const Event& child = events_map.at(child_id);
+							child_allocations += child.allocations;
+							child_bytes += child.allocated_bytes;
+						}
+					}
+					allocations_exclusive += e.allocations > child_allocations ? e.allocations - child_allocations : 0;
+					allocated_bytes_exclusive += e.allocated_bytes > child_bytes ? e.allocated_bytes - child_bytes : 0;
+				}
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				{
+					//spans are attributed to the cpu they started on
+					std::map<int, std::vector<std::pair<uint_fast64_t, bool>>> per_cpu{}, per_node{};
+					for (const auto& e : all_events) {
+						if (e.start_cpu == unknown_cpu)
+							continue;
+						const uint_fast64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count();
+						const bool migrated = e.end_cpu != unknown_cpu && e.end_cpu != e.start_cpu;
+						migrations += migrated ? 1 : 0;
+						per_cpu[e.start_cpu].push_back({ duration, migrated });
+						auto node = cpu_nodes.find(e.start_cpu);
+						if (node != cpu_nodes.end() && node->second >= 0)
+							per_node[node->second].push_back({ duration, migrated });
+					}
+					cpus = create_cpu_latencies(per_cpu);
+					for (auto& cpu : cpus) {
+						auto node = cpu_nodes.find(cpu.id);
+						cpu.node = node != cpu_nodes.end() ? node->second : -1;
+					}
+					if (per_node.size() > 1)
+						numa_nodes = create_cpu_latencies(per_node);
+				}
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+				for (const auto& e : all_events) {
+					if (!e.has_cpu_time)
+						continue;
+					cpu_time_calls++;
+					cpu_time_total += e.cpu_time;
+					cpu_wall_time_total += e.cpu_wall_time;
+				}
+#endif
+#ifdef CTRACK_HAS_PERF_COUNTERS
+				for (const auto& e : all_events) {
+					for (int i = 0; i < 4; i++) {
+						if ((e.counter_mask >> i) & 1) {
+							counter_totals[i] += e.counters[i];
+							counter_calls[i]++;
+						}
+					}
+				}
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+				for (const auto& e : all_events)
+					rusage_all.add(e);
+#endif
+
+				all_mean = all_time_acc * factor;
 				if (std::fpclassify(all_mean) == FP_ZERO) return;
 
 				all_st = calculate_std_dev_field(all_events_simple, &Simple_Event::duration, all_mean);// std::sqrt(all_variance);
 				all_cv = all_st / all_mean;
+				all_med = all_cnt % 2 == 1 ? static_cast<double>(all_events_simple[all_cnt / 2].duration) :
+					(all_events_simple[all_cnt / 2].duration + all_events_simple[all_cnt / 2 - 1].duration) / 2.0;
+
+				if (settings.bootstrap_resamples > 0) {
+					all_bootstrap = bootstrap_confidence_intervals(all_events_simple, settings);
+					std::vector<uint_fast64_t> durations(all_cnt);
+					std::transform(all_events_simple.begin(), all_events_simple.end(), durations.begin(), [](const Simple_Event& e) { return e.duration; });
+					all_quantiles.clear();
+					for (double q : settings.bootstrap_quantiles)
+						all_quantiles.push_back(sorted_quantile(durations, q / 100.0));
+				}
 
-				all_thread_cnt = static_cast<unsigned int>(count_distinct_field_values(all_events, &Event::thread_id));
+				if (settings.concurrency_scaling && all_thread_cnt > 1)
+					scaling = create_concurrency_scaling(all_events);
+				const unsigned int non_center_percent = settings.non_center_percent;
 				unsigned int amount_non_center = all_cnt * non_center_percent / 100;
 
 				fastest_range = non_center_percent;
@@ -526,6 +1357,22 @@ namespace ctrack {
 						center_events_simple.push_back(all_events_simple[i]);
 					}
 				}
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				for (const auto& e : fastest_events_simple)
+					migrations_fastest.add(events_map.at(e.unique_id));
+				for (const auto& e : center_events_simple)
+					migrations_center.add(events_map.at(e.unique_id));
+				for (const auto& e : slowest_events_simple)
+					migrations_slowest.add(events_map.at(e.unique_id));
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+				for (const auto& e : fastest_events_simple)
+					rusage_fastest.add(events_map.at(e.unique_id));
+				for (const auto& e : center_events_simple)
+					rusage_center.add(events_map.at(e.unique_id));
+				for (const auto& e : slowest_events_simple)
+					rusage_slowest.add(events_map.at(e.unique_id));
+#endif
 				if (amount_non_center > 0) {
 					//fastest
 					fastest_min = fastest_events_simple[0].duration;
@@ -545,7 +1392,7 @@ namespace ctrack {
 				else
 					center_med = (center_events_simple[center_events_simple.size() / 2].duration + center_events_simple[center_events_simple.size() / 2 - 1].duration) / 2;
 
-				auto center_child_events_simple = load_child_events_simple(center_events_simple, events_map, child_graph);
+				auto center_child_events_simple = load_child_events_simple(center_events_simple, events_map, child_graph, cross_child_graph);
 
 				std::sort(OPT_EXEC_POLICY center_events_simple.begin(), center_events_simple.end(), cmp_simple_event_by_start_time_asc);
 				center_grouped = sorted_create_grouped_simple_events(center_events_simple);
@@ -556,6 +1403,10 @@ namespace ctrack {
 				center_time_active_exclusive = center_time_active - sum_field(center_child_events_grouped, &Simple_Event::duration);
 
 				std::sort(OPT_EXEC_POLICY all_events_simple.begin(), all_events_simple.end(), cmp_simple_event_by_start_time_asc);
+				if (settings.detect_change_points)
+					change_points = detect_change_points(all_events_simple, settings);
+				if (settings.heatmap_time_buckets > 0)
+					heatmap = create_latency_heatmap(all_events_simple, settings.heatmap_time_buckets, settings.heatmap_duration_buckets);
 				all_grouped = sorted_create_grouped_simple_events(all_events_simple);
 				all_time_active = sum_field(all_grouped, &Simple_Event::duration);
 
@@ -568,11 +1419,16 @@ namespace ctrack {
 
 			double all_cv = 0.0;
 			double all_st = 0.0;
+			double all_mean = 0.0;
+			double all_med = 0.0;
+			std::vector<double> all_quantiles = {}; //ctrack_result_settings::bootstrap_quantiles, only with bootstrap enabled
+			bootstrap_result all_bootstrap = {};
 
 			unsigned int all_cnt = 0;
 			uint_fast64_t all_time_acc = 0;
 			uint_fast64_t all_time_active = 0;
 			uint_fast64_t all_time_active_exclusive = 0;
+			uint_fast64_t all_time_forked = 0; //covered by forked or adopted children on other threads, not subtracted from exclusive time
 			unsigned int all_thread_cnt = 0;
 			std::vector<Simple_Event> all_grouped = {};
 			std::vector<Event> all_events = {};
@@ -597,6 +1453,34 @@ namespace ctrack {
 			uint_fast64_t center_time_active_exclusive = 0;
 			std::vector<Simple_Event> center_grouped = {};
 
+			std::vector<change_point> change_points = {}; //only with detect_change_points enabled
+			latency_heatmap heatmap = {}; //only with heatmap_time_buckets > 0
+			concurrency_scaling scaling = {}; //only with concurrency_scaling enabled and calls from several threads
+			arg_scaling args = {}; //only for callsites using CTRACK_ARG
+#ifdef CTRACK_HAS_PERF_COUNTERS
+			uint64_t counter_totals[4] = {}; //cycles, instructions, LLC misses, branch misses, inclusive of children
+			unsigned int counter_calls[4] = {}; //calls with a valid value for the counter
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+			unsigned int allocation_calls = 0;
+			uint64_t allocations_inclusive = 0, allocations_exclusive = 0;
+			uint64_t allocated_bytes_inclusive = 0, allocated_bytes_exclusive = 0;
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			std::vector<cpu_latency> cpus = {}; //by start cpu
+			std::vector<cpu_latency> numa_nodes = {}; //by numa node of the start cpu, only with several nodes
+			unsigned int migrations = 0; //spans that ended on a different cpu than they started on
+			migration_counts migrations_fastest = {}, migrations_center = {}, migrations_slowest = {};
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+			rusage_counts rusage_all = {}, rusage_fastest = {}, rusage_center = {}, rusage_slowest = {}; //inclusive of children
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+			unsigned int cpu_time_calls = 0;
+			uint64_t cpu_time_total = 0; //inclusive of children, like all_time_acc
+			uint64_t cpu_wall_time_total = 0; //wall time of the same calls, measured next to the cpu time samples
+#endif
+
 			std::string filename = {};
 			std::string function_name = {};
 			int line = 0;
@@ -606,6 +1490,73 @@ namespace ctrack {
 		typedef std::vector<Event> t_events;
 		typedef std::map<unsigned int, std::vector<unsigned int>> sub_events;
 
+		//cross thread edge, recorded by the thread that finished the child
+		struct span_link {
+			uint_fast64_t parent_id;
+			uint_fast64_t child_id;
+		};
+		typedef std::vector<span_link> span_links;
+
+		//time a coroutine span was running on a thread, the rest of its duration it was suspended
+		struct coroutine_record {
+			uint_fast64_t uid;
+			uint_fast64_t active_time;
+			unsigned int suspensions;
+		};
+		typedef std::vector<coroutine_record> coroutine_records;
+
+		//item entering or leaving a queue, see CTRACK_ENQUEUE / CTRACK_DEQUEUE
+		struct queue_event {
+			std::chrono::high_resolution_clock::time_point time;
+			std::string_view queue;
+			uint_fast64_t item_id;
+			bool dequeue;
+		};
+		typedef std::vector<queue_event> queue_events;
+
+		//CTRACK_COUNT / CTRACK_GAUGE sample, span_id is the unique id of the enclosing span (0 outside of spans)
+		struct metric_record {
+			std::chrono::high_resolution_clock::time_point time;
+			std::string_view name;
+			double value;
+			uint_fast64_t span_id;
+			bool gauge;
+		};
+		typedef std::vector<metric_record> metric_records;
+
+		//CTRACK_ARG value of a span, kept out of Event so it stays at 64 bytes
+		struct span_arg {
+			uint_fast64_t event_uid;
+			double value;
+		};
+		typedef std::vector<span_arg> span_args;
+
+		struct batch_count {
+			unsigned int event_id;
+			uint_fast64_t items;
+		};
+		typedef std::vector<batch_count> batch_counts;
+
+		//one acquisition of a tracked_mutex / tracked_shared_mutex, recorded by the releasing thread
+		struct lock_event {
+			std::chrono::high_resolution_clock::time_point acquired, released;
+			uint_fast64_t wait; //0 when the lock was free
+			uint_fast64_t holder_id; //unique id of the innermost span of the locking thread, 0 outside of spans
+			std::string_view name, filename; //name and construction site of the mutex
+			int line;
+			std::string_view site_filename, site_function; //caller of CTRACK_LOCK / CTRACK_LOCK_SHARED, empty for a plain lock()
+			int site_line;
+			bool contended;
+			bool shared;
+		};
+		typedef std::vector<lock_event> lock_events;
+
+		//captured on the forking thread, passed to the worker
+		struct fork_point {
+			uint_fast64_t parent_id = 0;
+			unsigned int store_clear_cnt = 0;
+		};
+
 
 
 		struct store
@@ -618,6 +1569,13 @@ namespace ctrack {
 			inline static std::atomic<int> thread_cnt = -1;
 			inline static std::deque<t_events> a_events{};
 			inline static std::deque<sub_events> a_sub_events{};
+			inline static std::deque<span_links> a_span_links{};
+			inline static std::deque<coroutine_records> a_coroutine_records{};
+			inline static std::deque<queue_events> a_queue_events{};
+			inline static std::deque<metric_records> a_metric_records{};
+			inline static std::deque<span_args> a_span_args{};
+			inline static std::deque<batch_counts> a_batch_counts{};
+			inline static std::deque<lock_events> a_lock_events{};
 
 			inline static std::deque<unsigned int> a_current_event_id{}, a_current_event_cnt{}, a_string_id{};
 
@@ -626,6 +1584,15 @@ namespace ctrack {
 
 		inline thread_local  t_events* event_ptr = nullptr;
 		inline thread_local sub_events* sub_events_ptr = nullptr;
+		inline thread_local span_links* span_links_ptr = nullptr;
+		inline thread_local coroutine_records* coroutine_records_ptr = nullptr;
+		inline thread_local queue_events* queue_events_ptr = nullptr;
+		inline thread_local metric_records* metric_records_ptr = nullptr;
+		inline thread_local span_args* span_args_ptr = nullptr;
+		inline thread_local batch_counts* batch_counts_ptr = nullptr;
+		inline thread_local lock_events* lock_events_ptr = nullptr;
+		inline thread_local fork_point linked_parent{};
+		inline thread_local fork_point running_coroutine{}; //CTRACK_CORO span running on this thread, if any
 
 		inline thread_local unsigned int* current_event_id = nullptr;
 		inline thread_local unsigned int* current_event_cnt = nullptr;
@@ -637,35 +1604,345 @@ namespace ctrack {
 		typedef std::map<std::string_view, line_result> function_result;
 		typedef std::map < std::string_view, function_result> filename_result;
 
-		struct ctrack_result_settings {
-			unsigned int non_center_percent = 1;
-			double min_percent_active_exclusive = 0.0; //between 0-100
-			double percent_exclude_fastest_active_exclusive = 0.0; //between 0-100
+		struct critical_path_segment {
+			const Event* event = nullptr;
+			std::chrono::high_resolution_clock::time_point start_time{}, end_time{}; //part of the event that lies on the path
 		};
 
-		class ctrack_result {
-		public:
+		struct critical_path_share {
+			std::string_view filename{}, function{};
+			int line = 0;
+			uint_fast64_t time_on_path = 0;
+			double share = 0.0; //between 0-100 of the summed root span durations
+		};
 
-			ctrack_result(const ctrack_result_settings& settings, const std::chrono::high_resolution_clock::time_point& track_start_time, const std::chrono::high_resolution_clock::time_point& track_end_time) :
-				settings(settings), track_start_time(track_start_time), track_end_time(track_end_time)
-			{
-				time_total = std::chrono::duration_cast<std::chrono::nanoseconds>(
-					track_end_time - track_start_time).count();
-				center_intervall_str = "[" + std::to_string(settings.non_center_percent) + "-" + std::to_string(100 - settings.non_center_percent) + "]";
+		struct critical_path_result {
+			const Event* root = nullptr; //longest root span
+			std::vector<critical_path_segment> segments = {}; //critical path of the longest root span in time order
+			std::vector<critical_path_share> shares = {}; //aggregated over the critical paths of all root spans, largest first
+			uint_fast64_t total_root_time = 0;
+		};
+
+		//walks backwards from the end of the root: the child (same thread or forked) that finished last before the cursor
+		//is on the path, the gaps between those children are time of the span itself
+		inline void walk_critical_path(const Event& root, const std::unordered_map<int_fast64_t, Event>& events_map,
+			const std::unordered_map<int_fast64_t, std::vector<int_fast64_t>>& child_graph,
+			const std::unordered_map<int_fast64_t, std::vector<int_fast64_t>>& cross_child_graph,
+			std::vector<critical_path_segment>& segments) {
+			using time_point = std::chrono::high_resolution_clock::time_point;
+			struct frame {
+				const Event* event;
+				time_point cursor;
+				std::vector<const Event*> children;
+				size_t next_child;
+			};
+			auto make_frame = [&](const Event* e, time_point end) {
+				frame f{ e, end, {}, 0 };
+				const auto uid = static_cast<int_fast64_t>(get_unique_event_id(e->thread_id, e->event_id));
+				for (const auto* graph : { &child_graph, &cross_child_graph }) {
+					auto it = graph->find(uid);
+					if (it == graph->end())
+						continue;
+					for (auto child_id : it->second) {
+						auto child = events_map.find(child_id);
+						if (child != events_map.end())
+							f.children.push_back(&child->second);
+					}
+				}
+				std::sort(f.children.begin(), f.children.end(), [](const Event* a, const Event* b) { return a->end_time > b->end_time; });
+				return f;
+				};
+
+			std::vector<critical_path_segment> backwards{};
+			std::vector<frame> stack{};
+			stack.push_back(make_frame(&root, root.end_time));
+			while (stack.size() > 0) {
+				frame& f = stack.back();
+				const Event* next = nullptr;
+				while (f.next_child < f.children.size()) {
+					const Event* child = f.children[f.next_child++];
+					if (child->start_time < f.cursor && child->end_time > f.event->start_time) {
+						next = child;
+						break;
+					}
+				}
+				if (next == nullptr) {
+					if (f.cursor > f.event->start_time)
+						backwards.push_back({ f.event, f.event->start_time, f.cursor });
+					stack.pop_back();
+					continue;
+				}
+				const time_point child_end = std::min(next->end_time, f.cursor);
+				if (f.cursor > child_end)
+					backwards.push_back({ f.event, child_end, f.cursor });
+				f.cursor = std::max(next->start_time, f.event->start_time);
+				stack.push_back(make_frame(next, child_end));
 			}
+			//segments are emitted from the end, a span's own segments may be interleaved with its children
+			segments.insert(segments.end(), backwards.rbegin(), backwards.rend());
+		}
 
-			template<typename StreamType>
-			void get_summary_table(StreamType& stream, bool use_color = false) {
-				BeautifulTable info({ "Start","End","time total","time ctracked","time ctracked %", }, use_color, alternate_colors);
-				info.addRow({ BeautifulTable::table_timepoint(track_start_time), BeautifulTable::table_timepoint(track_end_time),
-					BeautifulTable::table_time(time_total), BeautifulTable::table_time(sum_time_active_exclusive),
-					BeautifulTable::table_percentage(sum_time_active_exclusive, time_total)
-					});
+		struct serial_callsite {
+			std::string_view filename{}, function{};
+			int line = 0;
+			uint_fast64_t serial_time = 0; //exclusive time while no other thread was inside tracked work
+		};
 
-				info.print(stream);
-				BeautifulTable table({ "filename", "function", "line","calls","ae" + center_intervall_str + "%","ae[0-100]%",
-					"time ae[0-100]" ,"time a[0-100]" }, use_color, alternate_colors);
-				for (auto& entry : sorted_events) {
+		struct amdahl_result {
+			std::vector<uint_fast64_t> time_at_concurrency = {}; //index is the number of threads inside tracked work
+			double serial_fraction = 0.0; //serial work / all tracked work
+			double average_parallelism = 0.0; //tracked work / time with at least one thread inside tracked work
+			std::vector<std::pair<unsigned int, double>> projected_speedup = {}; //cores, speedup over one core
+			std::vector<serial_callsite> serial_callsites = {}; //largest first
+		};
+
+		//innermost tracked span per point in time of one thread, requires the events of one thread sorted by start time (outer first)
+		inline void create_innermost_segments(const std::vector<const Event*>& events, std::vector<std::pair<Simple_Event, const Event*>>& segments) {
+			using time_point = std::chrono::high_resolution_clock::time_point;
+			std::vector<const Event*> stack{};
+			time_point cursor{};
+			auto emit = [&](const Event* e, time_point end) {
+				if (end > cursor)
+					segments.push_back({ Simple_Event(cursor, end, std::chrono::duration_cast<std::chrono::nanoseconds>(end - cursor).count(), 0), e });
+				cursor = std::max(cursor, end);
+				};
+			for (const Event* e : events) {
+				while (stack.size() > 0 && stack.back()->end_time <= e->start_time) {
+					emit(stack.back(), stack.back()->end_time);
+					stack.pop_back();
+				}
+				if (stack.size() > 0)
+					emit(stack.back(), e->start_time);
+				cursor = std::max(cursor, e->start_time);
+				stack.push_back(e);
+			}
+			while (stack.size() > 0) {
+				emit(stack.back(), stack.back()->end_time);
+				stack.pop_back();
+			}
+		}
+
+		struct callsite_overlap {
+			size_t a = 0, b = 0; //index into overlap_result::callsites
+			uint_fast64_t overlap_time = 0;
+		};
+
+		struct overlap_result {
+			std::vector<const EventGroup*> callsites = {};
+			std::vector<uint_fast64_t> matrix = {}; //a * callsites.size() + b, time a and b were active on different threads
+			std::vector<callsite_overlap> pairs = {}; //largest first
+		};
+
+		//merged intervals per thread, unique_id holds the thread id, sorted by start time
+		inline std::vector<Simple_Event> create_thread_grouped_simple_events(const std::vector<Event>& events) {
+			std::map<int, std::vector<Simple_Event>> per_thread{};
+			for (const auto& e : events) {
+				per_thread[e.thread_id].emplace_back(e.start_time, e.end_time,
+					std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count(), e.thread_id);
+			}
+			std::vector<Simple_Event> res{};
+			for (auto& [t_id, simple] : per_thread) {
+				std::sort(simple.begin(), simple.end(), cmp_simple_event_by_start_time_asc);
+				auto grouped = sorted_create_grouped_simple_events(simple);
+				res.insert(res.end(), grouped.begin(), grouped.end());
+			}
+			std::sort(res.begin(), res.end(), cmp_simple_event_by_start_time_asc);
+			return res;
+		}
+
+		//time during which a runs on one thread while b runs on another thread, nesting on the same thread does not count
+		inline uint_fast64_t cross_thread_overlap(const std::vector<Simple_Event>& a, const std::vector<Simple_Event>& b) {
+			using time_point = std::chrono::high_resolution_clock::time_point;
+			struct boundary {
+				time_point time;
+				int delta;
+				bool is_a;
+				int_fast64_t t_id;
+			};
+			std::vector<boundary> boundaries{};
+			boundaries.reserve(2 * (a.size() + b.size()));
+			for (const auto& e : a) {
+				boundaries.push_back({ e.start_time, 1, true, e.unique_id });
+				boundaries.push_back({ e.end_time, -1, true, e.unique_id });
+			}
+			for (const auto& e : b) {
+				boundaries.push_back({ e.start_time, 1, false, e.unique_id });
+				boundaries.push_back({ e.end_time, -1, false, e.unique_id });
+			}
+			std::sort(boundaries.begin(), boundaries.end(), [](const boundary& x, const boundary& y) { return x.time < y.time; });
+
+			std::unordered_map<int_fast64_t, std::pair<int, int>> active{};
+			int active_a = 0, active_b = 0, active_both = 0;
+			uint_fast64_t overlap = 0;
+			time_point previous{};
+			for (const auto& bd : boundaries) {
+				if (active_a > 0 && active_b > 0 && !(active_a == 1 && active_b == 1 && active_both == 1))
+					overlap += std::chrono::duration_cast<std::chrono::nanoseconds>(bd.time - previous).count();
+				previous = bd.time;
+
+				auto& [thread_a, thread_b] = active[bd.t_id];
+				const bool both_before = thread_a > 0 && thread_b > 0;
+				(bd.is_a ? thread_a : thread_b) += bd.delta;
+				(bd.is_a ? active_a : active_b) += bd.delta;
+				const bool both_after = thread_a > 0 && thread_b > 0;
+				active_both += static_cast<int>(both_after) - static_cast<int>(both_before);
+			}
+			return overlap;
+		}
+
+		struct queue_stats {
+			std::string_view name{};
+			unsigned int enqueued = 0;
+			unsigned int dequeued = 0;
+			unsigned int pending = 0; //enqueued but not dequeued when the results were taken
+			double mean_wait = 0.0;
+			double p50_wait = 0.0, p90_wait = 0.0, p99_wait = 0.0;
+			uint_fast64_t max_wait = 0;
+			double throughput = 0.0; //dequeued items per second between the first enqueue and the last dequeue
+			double mean_depth = 0.0; //Little's law: throughput * mean wait
+		};
+
+		struct counter_stats {
+			std::string_view filename{}, function{}; //empty for counts outside of spans
+			int line = 0;
+			std::string_view name{};
+			double total = 0.0;
+			unsigned int spans = 0; //calls of the callsite that counted
+			double per_call = 0.0;
+			double rate = 0.0; //per second of time active of the callsite, outside of spans per second tracked
+			bool unfinished = false; //counted inside spans that had not ended when the result was calculated
+		};
+
+		struct gauge_stats {
+			std::string_view name{};
+			unsigned int samples = 0;
+			double min = 0.0, mean = 0.0, max = 0.0;
+			double time_weighted_mean = 0.0; //each sample holds until the next one
+			double last = 0.0;
+		};
+
+		//per item latencies of CTRACK_BATCH spans, every batch is weighted with its item count
+		struct batch_stats {
+			std::string_view filename{}, function{};
+			int line = 0;
+			unsigned int batches = 0;
+			uint_fast64_t items = 0;
+			double mean_items = 0.0;
+			double item_mean = 0.0;
+			double item_p50 = 0.0, item_p90 = 0.0, item_p99 = 0.0;
+			double fastest_item_mean = 0.0; //fastest non_center_percent of the items
+			double slowest_item_mean = 0.0;
+			double items_per_second = 0.0; //per second of time active of the callsite
+		};
+
+		struct frame_breakdown_entry {
+			std::string_view filename{}, function{};
+			int line = 0;
+			double slow_time = 0.0; //mean exclusive time per slow frame
+			double typical_time = 0.0; //mean exclusive time per typical frame
+		};
+
+		struct frame_stats {
+			std::string_view filename{}, function{};
+			int line = 0;
+			unsigned int cnt = 0;
+			unsigned int slow_cnt = 0;
+			double mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0;
+			uint_fast64_t max = 0;
+			double slow_threshold = 0.0; //ns, frame_slow_percentile of the durations
+			double slow_mean = 0.0, typical_mean = 0.0;
+			std::vector<frame_breakdown_entry> breakdown = {}; //largest slow minus typical difference first
+		};
+
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+		struct migrated_span {
+			const EventGroup* group = nullptr;
+			const Event* event = nullptr;
+			uint_fast64_t duration = 0;
+		};
+#endif
+
+		//locking callsite, the CTRACK_LOCK site or else the innermost span of the locking thread
+		struct lock_holder {
+			std::string_view filename{}, function{}; //empty for plain lock() calls outside of spans
+			int line = 0;
+			unsigned int acquisitions = 0;
+			unsigned int contended = 0;
+			uint_fast64_t wait_time = 0;
+			uint_fast64_t hold_time = 0;
+			uint_fast64_t max_hold = 0;
+		};
+
+		struct lock_stats {
+			std::string_view name{}, filename{};
+			int line = 0;
+			unsigned int acquisitions = 0;
+			unsigned int shared_acquisitions = 0;
+			unsigned int contended = 0;
+			double contention_rate = 0.0; //percent of the acquisitions that had to wait
+			uint_fast64_t wait_time = 0;
+			double wait_p50 = 0.0, wait_p90 = 0.0, wait_p99 = 0.0; //over contended acquisitions
+			uint_fast64_t wait_max = 0;
+			uint_fast64_t hold_time = 0;
+			double hold_mean = 0.0, hold_p99 = 0.0;
+			std::vector<lock_holder> holders = {}; //by wait time, then hold time, longest first
+		};
+
+		struct coroutine_stats {
+			std::string_view filename{}, function{};
+			int line = 0;
+			unsigned int cnt = 0;
+			double mean_time = 0.0; //start to end
+			double mean_active = 0.0;
+			double mean_suspended = 0.0;
+			uint_fast64_t max_suspended = 0;
+			double mean_suspensions = 0.0;
+		};
+
+		struct region_instance {
+			const Event* region = nullptr;
+			std::vector<std::pair<int, uint_fast64_t>> worker_time = {}; //thread id, busy time inside the region
+			uint_fast64_t max_time = 0;
+			double mean_time = 0.0;
+			double imbalance = 0.0; //max / mean - 1 in percent
+			std::vector<int> stragglers = {};
+		};
+
+		struct region_imbalance {
+			std::string_view filename{}, function{};
+			int line = 0;
+			std::vector<region_instance> instances = {};
+			double mean_imbalance = 0.0;
+			double max_imbalance = 0.0;
+			double mean_max_time = 0.0;
+			double mean_mean_time = 0.0;
+			double mean_workers = 0.0;
+			std::map<int, unsigned int> straggler_cnt = {}; //thread id, instances the thread was a straggler
+		};
+
+		class ctrack_result {
+		public:
+
+			ctrack_result(const ctrack_result_settings& settings, const std::chrono::high_resolution_clock::time_point& track_start_time, const std::chrono::high_resolution_clock::time_point& track_end_time) :
+				settings(settings), track_start_time(track_start_time), track_end_time(track_end_time)
+			{
+				time_total = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					track_end_time - track_start_time).count();
+				center_intervall_str = "[" + std::to_string(settings.non_center_percent) + "-" + std::to_string(100 - settings.non_center_percent) + "]";
+			}
+
+			template<typename StreamType>
+			void get_summary_table(StreamType& stream, bool use_color = false) {
+				BeautifulTable info({ "Start","End","time total","time ctracked","time ctracked %", }, use_color, alternate_colors);
+				info.addRow({ BeautifulTable::table_timepoint(track_start_time), BeautifulTable::table_timepoint(track_end_time),
+					BeautifulTable::table_time(time_total), BeautifulTable::table_time(sum_time_active_exclusive),
+					BeautifulTable::table_percentage(sum_time_active_exclusive, time_total)
+					});
+
+				info.print(stream);
+				BeautifulTable table({ "filename", "function", "line","calls","ae" + center_intervall_str + "%","ae[0-100]%",
+					"time ae[0-100]" ,"time a[0-100]" }, use_color, alternate_colors);
+				for (auto& entry : sorted_events) {
 					table.addRow({ BeautifulTable::stable_shortenPath(entry->filename), entry->function_name,BeautifulTable::table_string(entry->line),
 						BeautifulTable::table_string(entry->all_cnt),
 						BeautifulTable::table_percentage(entry->center_time_active_exclusive, time_total),
@@ -685,11 +1962,17 @@ namespace ctrack {
 				for (int i = static_cast<int>(sorted_events.size()) - 1; i >= 0; i--) {
 					auto& entry = sorted_events[i];
 
-					BeautifulTable info({ "filename", "function", "line","time acc","sd","cv","calls","threads" }, use_color, default_colors);
-					info.addRow({ BeautifulTable::stable_shortenPath(entry->filename), entry->function_name,BeautifulTable::table_string(entry->line),
+					std::vector<std::string> info_header{ "filename", "function", "line","time acc","sd","cv","calls","threads" };
+					std::vector<std::string> info_row{ BeautifulTable::stable_shortenPath(entry->filename), entry->function_name,BeautifulTable::table_string(entry->line),
 						BeautifulTable::table_time(entry->all_time_acc),
 						BeautifulTable::table_time(sorted_events[i]->all_st),BeautifulTable::table_string(sorted_events[i]->all_cv),
-						BeautifulTable::table_string(sorted_events[i]->all_cnt),	BeautifulTable::table_string(sorted_events[i]->all_thread_cnt) });
+						BeautifulTable::table_string(sorted_events[i]->all_cnt),	BeautifulTable::table_string(sorted_events[i]->all_thread_cnt) };
+					if (entry->all_time_forked > 0) {
+						info_header.push_back("time forked");
+						info_row.push_back(BeautifulTable::table_time(entry->all_time_forked));
+					}
+					BeautifulTable info(info_header, use_color, default_colors);
+					info.addRow(info_row);
 
 					BeautifulTable table({ "min", "mean", "min","mean","med","time a","time ae","max","mean","max" }, use_color, default_colors,
 						{ {"fastest[0-" + std::to_string(settings.non_center_percent) + "]%",2},{"center" + center_intervall_str + "%",6},
@@ -705,164 +1988,2681 @@ namespace ctrack {
 					info.print(stream);
 					table.print(stream);
 
+					//callsites of only zero length calls return before the quantiles are computed
+					if (settings.bootstrap_resamples > 0 && entry->all_quantiles.size() == settings.bootstrap_quantiles.size() &&
+						entry->all_bootstrap.quantiles.size() == settings.bootstrap_quantiles.size()) {
+						const std::string ci_str = " ci" + BeautifulTable::table_string(settings.bootstrap_confidence) + "%";
+						std::vector<std::string> header{ "mean", "mean" + ci_str, "med", "med" + ci_str };
+						std::vector<std::string> row{ BeautifulTable::table_time(entry->all_mean), BeautifulTable::table_interval(entry->all_bootstrap.mean),
+							BeautifulTable::table_time(entry->all_med), BeautifulTable::table_interval(entry->all_bootstrap.med) };
+						for (size_t q = 0; q < settings.bootstrap_quantiles.size(); q++) {
+							const std::string name = "p" + BeautifulTable::table_string(settings.bootstrap_quantiles[q]);
+							header.push_back(name);
+							header.push_back(name + ci_str);
+							row.push_back(BeautifulTable::table_time(entry->all_quantiles[q]));
+							row.push_back(BeautifulTable::table_interval(entry->all_bootstrap.quantiles[q]));
+						}
+						BeautifulTable ci_table(header, use_color, default_colors);
+						ci_table.addRow(row);
+						ci_table.print(stream);
+					}
+
+					if (entry->change_points.size() > 0) {
+						BeautifulTable cp_table({ "time", "offset", "calls before", "mean before", "mean after", "change" }, use_color, default_colors,
+							{ {"change points",6} });
+						for (const auto& cp : entry->change_points) {
+							cp_table.addRow({ BeautifulTable::table_timepoint(cp.time),
+								BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(cp.time - track_start_time).count())),
+								BeautifulTable::table_string(cp.calls_before), BeautifulTable::table_time(cp.mean_before),
+								BeautifulTable::table_time(cp.mean_after), BeautifulTable::table_change(cp.mean_after, cp.mean_before) });
+						}
+						cp_table.print(stream);
+					}
+
+					if (entry->scaling.levels.size() > 1) {
+						const auto& scaling = entry->scaling;
+						std::ostringstream fit;
+						fit << "contention " << std::fixed << std::setprecision(2) << scaling.contention() << "% per thread, R^2 " << scaling.r_squared;
+						BeautifulTable cs_table({ "concurrent threads", "calls", "mean", "p99", "fit" }, use_color, default_colors,
+							{ {"concurrency scaling",2},{fit.str(),3} });
+						for (const auto& l : scaling.levels) {
+							cs_table.addRow({ BeautifulTable::table_string(l.level), BeautifulTable::table_string(l.cnt), BeautifulTable::table_time(l.mean),
+								BeautifulTable::table_time(l.p99), BeautifulTable::table_time(std::max(0.0, scaling.intercept + scaling.slope * l.level)) });
+						}
+						cs_table.print(stream);
+					}
+
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+					if (entry->allocation_calls > 0) {
+						auto per_call = [&](uint64_t value) { return BeautifulTable::table_quantity(static_cast<double>(value) / entry->allocation_calls); };
+						BeautifulTable alloc_table({ "allocations", "bytes", "allocations", "bytes", "allocations", "bytes" }, use_color, default_colors,
+							{ {"per call inclusive",2},{"per call exclusive",2},{"total exclusive",2} });
+						alloc_table.addRow({ per_call(entry->allocations_inclusive), per_call(entry->allocated_bytes_inclusive),
+							per_call(entry->allocations_exclusive), per_call(entry->allocated_bytes_exclusive),
+							BeautifulTable::table_quantity(static_cast<double>(entry->allocations_exclusive)), BeautifulTable::table_quantity(static_cast<double>(entry->allocated_bytes_exclusive)) });
+						alloc_table.print(stream);
+					}
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+					if (entry->cpus.size() > 0) {
+						BeautifulTable cpu_table({ "cpu", "node", "calls", "migrated", "mean", "median", "max" }, use_color, default_colors,
+							{ {"latency by start cpu",7} });
+						for (const auto& cpu : entry->cpus) {
+							cpu_table.addRow({ BeautifulTable::table_string(cpu.id), cpu.node >= 0 ? BeautifulTable::table_string(cpu.node) : "-",
+								BeautifulTable::table_string(cpu.calls), BeautifulTable::table_string(cpu.migrated), BeautifulTable::table_time(cpu.mean),
+								BeautifulTable::table_time(cpu.median), BeautifulTable::table_time(cpu.max) });
+						}
+						cpu_table.print(stream);
+					}
+					if (entry->numa_nodes.size() > 0) {
+						BeautifulTable node_table({ "node", "calls", "migrated", "mean", "median", "max" }, use_color, default_colors,
+							{ {"latency by numa node",6} });
+						for (const auto& node : entry->numa_nodes) {
+							node_table.addRow({ BeautifulTable::table_string(node.id), BeautifulTable::table_string(node.calls), BeautifulTable::table_string(node.migrated),
+								BeautifulTable::table_time(node.mean), BeautifulTable::table_time(node.median), BeautifulTable::table_time(node.max) });
+						}
+						node_table.print(stream);
+					}
+					if (entry->migrations > 0) {
+						BeautifulTable band_table({ "band", "calls", "migrated", "migrated %" }, use_color, default_colors, { {"cpu migrations by band",4} });
+						auto add_band = [&](const std::string& band, const migration_counts& counts) {
+							if (counts.calls == 0)
+								return;
+							band_table.addRow({ band, BeautifulTable::table_string(counts.calls), BeautifulTable::table_string(counts.migrated),
+								BeautifulTable::table_percentage(counts.migrated, counts.calls) });
+						};
+						add_band("fastest[0-" + std::to_string(entry->fastest_range) + "]%", entry->migrations_fastest);
+						add_band("center" + center_intervall_str + "%", entry->migrations_center);
+						add_band("slowest[" + std::to_string(entry->slowest_range) + "-100]%", entry->migrations_slowest);
+						band_table.print(stream);
+					}
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+					if (entry->rusage_all.calls > 0) {
+						BeautifulTable rusage_table({ "band", "calls", "minor faults", "major faults", "voluntary", "involuntary" }, use_color, default_colors,
+							{ {"",2},{"faults per call",2},{"context switches per call",2} });
+						auto add_band = [&](const std::string& band, const rusage_counts& counts) {
+							if (counts.calls == 0)
+								return;
+							auto per_call = [&](uint64_t value) { return BeautifulTable::table_quantity(static_cast<double>(value) / counts.calls); };
+							rusage_table.addRow({ band, BeautifulTable::table_string(counts.calls), per_call(counts.minor_faults), per_call(counts.major_faults),
+								per_call(counts.voluntary_switches), per_call(counts.involuntary_switches) });
+						};
+						add_band("all", entry->rusage_all);
+						add_band("fastest[0-" + std::to_string(entry->fastest_range) + "]%", entry->rusage_fastest);
+						add_band("center" + center_intervall_str + "%", entry->rusage_center);
+						add_band("slowest[" + std::to_string(entry->slowest_range) + "-100]%", entry->rusage_slowest);
+						rusage_table.print(stream);
+					}
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+					if (entry->cpu_time_calls > 0) {
+						const uint64_t off_cpu = entry->cpu_wall_time_total > entry->cpu_time_total ? entry->cpu_wall_time_total - entry->cpu_time_total : 0;
+						BeautifulTable cpu_table({ "wall", "cpu", "off cpu", "wall", "cpu", "off cpu", "off cpu %" }, use_color, default_colors,
+							{ {"per call",3},{"total",4} });
+						cpu_table.addRow({ BeautifulTable::table_time(static_cast<double>(entry->cpu_wall_time_total) / entry->cpu_time_calls),
+							BeautifulTable::table_time(static_cast<double>(entry->cpu_time_total) / entry->cpu_time_calls),
+							BeautifulTable::table_time(static_cast<double>(off_cpu) / entry->cpu_time_calls),
+							BeautifulTable::table_time(static_cast<uint_fast64_t>(entry->cpu_wall_time_total)), BeautifulTable::table_time(static_cast<uint_fast64_t>(entry->cpu_time_total)),
+							BeautifulTable::table_time(static_cast<uint_fast64_t>(off_cpu)), BeautifulTable::table_percentage(off_cpu, entry->cpu_wall_time_total) });
+						cpu_table.print(stream);
+					}
+#endif
+#ifdef CTRACK_HAS_PERF_COUNTERS
+					if (entry->counter_calls[0] > 0 || entry->counter_calls[1] > 0) {
+						auto per_call = [&](int i) {
+							return entry->counter_calls[i] > 0 ? BeautifulTable::table_quantity(static_cast<double>(entry->counter_totals[i]) / entry->counter_calls[i]) : std::string("-");
+							};
+						auto total = [&](int i) {
+							return entry->counter_calls[i] > 0 ? BeautifulTable::table_quantity(static_cast<double>(entry->counter_totals[i])) : std::string("-");
+							};
+						std::string ipc = "-";
+						if (entry->counter_calls[0] > 0 && entry->counter_calls[1] > 0 && entry->counter_totals[0] > 0) {
+							std::ostringstream oss;
+							oss << std::fixed << std::setprecision(2) << static_cast<double>(entry->counter_totals[1]) / entry->counter_totals[0];
+							ipc = oss.str();
+						}
+						BeautifulTable hw_table({ "cycles", "instructions", "LLC misses", "branch misses", "IPC", "cycles", "instructions", "LLC misses", "branch misses" },
+							use_color, default_colors, { {"hardware counters per call",5},{"total",4} });
+						hw_table.addRow({ per_call(0), per_call(1), per_call(2), per_call(3), ipc, total(0), total(1), total(2), total(3) });
+						hw_table.print(stream);
+					}
+#endif
+
+					if (entry->args.buckets.size() > 0) {
+						BeautifulTable arg_table({ "argument", "calls", "mean argument", "mean", "p99" }, use_color, default_colors, { {"latency by argument",5} });
+						for (const auto& bucket : entry->args.buckets) {
+							const std::string range = bucket.log2_lower == non_positive_bucket ? "<= 0" :
+								BeautifulTable::table_quantity(std::ldexp(1.0, bucket.log2_lower)) + " - " + BeautifulTable::table_quantity(std::ldexp(1.0, bucket.log2_lower + 1));
+							arg_table.addRow({ range, BeautifulTable::table_string(bucket.cnt),
+								BeautifulTable::table_quantity(bucket.mean_arg), BeautifulTable::table_time(bucket.mean), BeautifulTable::table_time(bucket.p99) });
+						}
+						arg_table.print(stream);
+						if (entry->args.fits.size() > 0) {
+							BeautifulTable fit_table({ "model", "time per unit", "intercept", "R^2" }, use_color, default_colors, { {"complexity fit",4} });
+							for (const auto& fit : entry->args.fits) {
+								std::ostringstream r_squared;
+								r_squared << std::fixed << std::setprecision(4) << fit.r_squared;
+								fit_table.addRow({ fit.model, BeautifulTable::table_signed_time(fit.coefficient), BeautifulTable::table_signed_time(fit.intercept), r_squared.str() });
+							}
+							fit_table.print(stream);
+						}
+					}
+
 					stream << std::endl;
 				}
 			}
 
-			void calculate_stats() {
-				std::vector<Simple_Event> grouped_events{};
-				for (auto& [filename, filename_entry] : f_res)
-				{
-					ctracked_files++;
-					for (auto& [function, function_entry] : filename_entry) {
-						ctracked_functions++;
-						for (auto& [line, line_entry] : function_entry) {
-							ctracked_uses++;
-							line_entry.filename = filename;
-							line_entry.function_name = function;
-							line_entry.line = line;
-							line_entry.calculateStats(settings.non_center_percent, a_events, child_graph);
-							sorted_events.push_back(&line_entry);
-							grouped_events.insert(grouped_events.end(), line_entry.all_grouped.begin(), line_entry.all_grouped.end());
+			template<typename StreamType>
+			void get_heatmap(StreamType& stream, bool use_color = false) const {
+				static const char* shades[] = { " ", "\u2591", "\u2592", "\u2593", "\u2588" };
+				static const std::string RESET_COLOR = "\033[0m";
+				for (const auto* entry : sorted_events) {
+					const auto& heatmap = entry->heatmap;
+					if (heatmap.counts.size() == 0)
+						continue;
+					const unsigned int max_count = *std::max_element(heatmap.counts.begin(), heatmap.counts.end());
+					std::vector<std::string> labels{};
+					size_t label_width = 0;
+					for (unsigned int d = 0; d < heatmap.duration_buckets; d++) {
+						labels.push_back(BeautifulTable::table_time(heatmap.duration_edge(d)));
+						label_width = std::max(label_width, labels.back().length());
+					}
+
+					if (use_color) stream << default_colors.header_color;
+					stream << BeautifulTable::stable_shortenPath(entry->filename) << " " << entry->function_name << " " << entry->line;
+					if (use_color) stream << RESET_COLOR;
+					stream << "\n";
+					for (unsigned int d = heatmap.duration_buckets; d-- > 0;) {
+						stream << std::string(label_width - labels[d].length(), ' ') << labels[d] << " |";
+						if (use_color) stream << default_colors.row_color;
+						for (unsigned int t = 0; t < heatmap.time_buckets; t++) {
+							const unsigned int c = heatmap.count(t, d);
+							const size_t level = c == 0 ? 0 : 1 + static_cast<size_t>(3.0 * std::log1p(c) / std::log1p(max_count));
+							stream << shades[std::min<size_t>(level, 4)];
 						}
+						if (use_color) stream << RESET_COLOR;
+						stream << "|\n";
 					}
+					stream << std::string(label_width + 1, ' ') << "+" << std::string(heatmap.time_buckets, '-') << "+\n";
+					stream << std::string(label_width + 2, ' ') << BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.start_time - track_start_time).count()))
+						<< " .. " << BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.end_time - track_start_time).count()))
+						<< " since start, max " << max_count << " calls per cell\n\n";
 				}
+			}
 
-				std::sort(OPT_EXEC_POLICY grouped_events.begin(), grouped_events.end(), cmp_simple_event_by_start_time_asc);
-				auto all_grouped = sorted_create_grouped_simple_events(grouped_events);
-				sum_time_active_exclusive = sum_field(all_grouped, &Simple_Event::duration);
+			//one line per non empty cell, times in ns relative to the track start
+			template<typename StreamType>
+			void get_heatmap_csv(StreamType& stream) const {
+				stream << "filename,function,line,time_start_ns,time_end_ns,duration_lower_ns,duration_upper_ns,count\n";
+				for (const auto* entry : sorted_events) {
+					const auto& heatmap = entry->heatmap;
+					for (unsigned int d = 0; d < heatmap.duration_buckets; d++) {
+						for (unsigned int t = 0; t < heatmap.time_buckets; t++) {
+							if (heatmap.count(t, d) == 0)
+								continue;
+							stream << "\"" << entry->filename << "\",\"" << entry->function_name << "\"," << entry->line << ","
+								<< std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.time_edge(t) - track_start_time).count() << ","
+								<< std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.time_edge(t + 1) - track_start_time).count() << ","
+								<< static_cast<uint_fast64_t>(heatmap.duration_edge(d)) << "," << static_cast<uint_fast64_t>(heatmap.duration_edge(d + 1)) << ","
+								<< heatmap.count(t, d) << "\n";
+						}
+					}
+				}
+			}
 
-				order_pointer_vector_by_field(sorted_events, &EventGroup::all_time_active_exclusive, false);
+			template<typename StreamType>
+			void get_heatmap_json(StreamType& stream) const {
+				auto escape = [](const std::string& value) {
+					std::string res{};
+					for (char c : value) {
+						if (c == '"' || c == '\\') res += '\\';
+						res += c;
+					}
+					return res;
+					};
+				stream << "[";
+				bool first = true;
+				for (const auto* entry : sorted_events) {
+					const auto& heatmap = entry->heatmap;
+					if (heatmap.counts.size() == 0)
+						continue;
+					stream << (first ? "\n" : ",\n") << "{\"filename\":\"" << escape(entry->filename) << "\",\"function\":\"" << escape(entry->function_name)
+						<< "\",\"line\":" << entry->line
+						<< ",\"time_start_ns\":" << std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.start_time - track_start_time).count()
+						<< ",\"time_end_ns\":" << std::chrono::duration_cast<std::chrono::nanoseconds>(heatmap.end_time - track_start_time).count()
+						<< ",\"time_buckets\":" << heatmap.time_buckets << ",\"duration_edges_ns\":[";
+					for (unsigned int d = 0; d <= heatmap.duration_buckets; d++)
+						stream << (d == 0 ? "" : ",") << static_cast<uint_fast64_t>(heatmap.duration_edge(d));
+					stream << "],\"counts\":[";
+					for (unsigned int d = 0; d < heatmap.duration_buckets; d++) {
+						stream << (d == 0 ? "[" : ",[");
+						for (unsigned int t = 0; t < heatmap.time_buckets; t++)
+							stream << (t == 0 ? "" : ",") << heatmap.count(t, d);
+						stream << "]";
+					}
+					stream << "]}";
+					first = false;
+				}
+				stream << "\n]\n";
+			}
 
-				int fastest_events = static_cast<int>(sorted_events.size() * settings.percent_exclude_fastest_active_exclusive / 100);
-				//remove fastest keep in mind fastest elements are at the back
-				if (fastest_events > 0)
-					sorted_events.erase(sorted_events.end() - fastest_events, sorted_events.end());
+			void calculate_critical_path() {
+				std::unordered_set<int_fast64_t> children{};
+				for (const auto* graph : { &child_graph, &cross_child_graph })
+					for (const auto& [parent, childs] : *graph)
+						children.insert(childs.begin(), childs.end());
+
+				std::map<std::tuple<std::string_view, std::string_view, int>, uint_fast64_t> time_on_path{};
+				std::vector<critical_path_segment> segments{};
+				uint_fast64_t longest = 0;
+				for (const auto& [uid, e] : a_events) {
+					if (children.count(uid) > 0)
+						continue;
+					segments.clear();
+					walk_critical_path(e, a_events, child_graph, cross_child_graph, segments);
+					for (const auto& segment : segments) {
+						time_on_path[{ segment.event->filename, segment.event->function, segment.event->line }] +=
+							std::chrono::duration_cast<std::chrono::nanoseconds>(segment.end_time - segment.start_time).count();
+					}
+					const uint_fast64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count();
+					critical_path.total_root_time += duration;
+					if (critical_path.root == nullptr || duration > longest) {
+						longest = duration;
+						critical_path.root = &e;
+						critical_path.segments = segments;
+					}
+				}
 
-				uint_fast64_t min_time_active_exclusive = static_cast<uint_fast64_t>(time_total * settings.min_percent_active_exclusive / 100);
-				//remove fastest keep in mind fastest elements are at the back
-				if (min_time_active_exclusive > 0)
-					sorted_events.erase(std::remove_if(sorted_events.begin(), sorted_events.end(), [min_time_active_exclusive](EventGroup* e) {return e->all_time_active_exclusive < min_time_active_exclusive; }), sorted_events.end());
+				for (const auto& [key, time] : time_on_path) {
+					critical_path.shares.push_back({ std::get<0>(key), std::get<1>(key), std::get<2>(key), time,
+						critical_path.total_root_time > 0 ? 100.0 * time / critical_path.total_root_time : 0.0 });
+				}
+				std::sort(critical_path.shares.begin(), critical_path.shares.end(), [](const critical_path_share& a, const critical_path_share& b) {
+					return a.time_on_path > b.time_on_path;
+					});
+			}
+
+			template<typename StreamType>
+			void get_critical_path_table(StreamType& stream, bool use_color = false) const {
+				if (critical_path.root == nullptr)
+					return;
+				const auto* root = critical_path.root;
+				BeautifulTable info({ "root filename", "function", "line", "thread", "duration", "segments" }, use_color, alternate_colors);
+				info.addRow({ BeautifulTable::stable_shortenPath(std::string(root->filename)), std::string(root->function), BeautifulTable::table_string(root->line),
+					BeautifulTable::table_string(root->thread_id),
+					BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(root->end_time - root->start_time).count())),
+					BeautifulTable::table_string(critical_path.segments.size()) });
+				info.print(stream);
+
+				BeautifulTable path({ "#", "filename", "function", "line", "thread", "offset", "time on path" }, use_color, alternate_colors, { {"longest critical path",7} });
+				for (size_t i = 0; i < critical_path.segments.size() && i < settings.critical_path_max_segments; i++) {
+					const auto& segment = critical_path.segments[i];
+					path.addRow({ BeautifulTable::table_string(i), BeautifulTable::stable_shortenPath(std::string(segment.event->filename)),
+						std::string(segment.event->function), BeautifulTable::table_string(segment.event->line), BeautifulTable::table_string(segment.event->thread_id),
+						BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(segment.start_time - root->start_time).count())),
+						BeautifulTable::table_time(static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(segment.end_time - segment.start_time).count())) });
+				}
+				path.print(stream);
 
+				BeautifulTable shares({ "filename", "function", "line", "time on path", "share" }, use_color, alternate_colors, { {"critical path share of all root spans",5} });
+				for (const auto& share : critical_path.shares) {
+					shares.addRow({ BeautifulTable::stable_shortenPath(std::string(share.filename)), std::string(share.function), BeautifulTable::table_string(share.line),
+						BeautifulTable::table_time(share.time_on_path), BeautifulTable::table_percentage(share.time_on_path, critical_path.total_root_time) });
+				}
+				shares.print(stream);
 			}
 
-			void reserve_a_events(size_t size) {
-				a_events.reserve(size);
+			void calculate_amdahl() {
+				using time_point = std::chrono::high_resolution_clock::time_point;
+				std::map<int, std::vector<const Event*>> thread_events{};
+				for (const auto& [uid, e] : a_events)
+					thread_events[e.thread_id].push_back(&e);
+
+				std::vector<std::pair<time_point, int>> boundaries{};
+				std::vector<std::pair<Simple_Event, const Event*>> segments{};
+				for (auto& [t_id, events] : thread_events) {
+					std::sort(events.begin(), events.end(), [](const Event* a, const Event* b) {
+						return a->start_time < b->start_time || (a->start_time == b->start_time && a->end_time > b->end_time);
+						});
+					//a thread is busy while its innermost span is not a wait
+					const size_t first_segment = segments.size();
+					create_innermost_segments(events, segments);
+					for (size_t i = first_segment; i < segments.size(); i++) {
+						if (segments[i].second->kind == event_kind::wait)
+							continue;
+						boundaries.emplace_back(segments[i].first.start_time, 1);
+						boundaries.emplace_back(segments[i].first.end_time, -1);
+					}
+				}
+				std::sort(boundaries.begin(), boundaries.end());
+
+				amdahl.time_at_concurrency.assign(thread_events.size() + 1, 0);
+				std::vector<Simple_Event> serial_intervals{};
+				int active = 0;
+				time_point previous = track_start_time;
+				for (const auto& [time, delta] : boundaries) {
+					if (time > previous) {
+						const uint_fast64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(time - previous).count();
+						amdahl.time_at_concurrency[active] += duration;
+						if (active == 1)
+							serial_intervals.emplace_back(previous, time, duration, 0);
+						previous = time;
+					}
+					active += delta;
+				}
+				if (track_end_time > previous)
+					amdahl.time_at_concurrency[0] += std::chrono::duration_cast<std::chrono::nanoseconds>(track_end_time - previous).count();
+
+				double serial_work = 0.0, parallel_work = 0.0, busy_time = 0.0;
+				for (size_t k = 1; k < amdahl.time_at_concurrency.size(); k++) {
+					const double t = static_cast<double>(amdahl.time_at_concurrency[k]);
+					busy_time += t;
+					if (k == 1)
+						serial_work += t;
+					else
+						parallel_work += t * k;
+				}
+				if (serial_work + parallel_work > 0.0) {
+					amdahl.serial_fraction = serial_work / (serial_work + parallel_work);
+					amdahl.average_parallelism = (serial_work + parallel_work) / busy_time;
+				}
+				//64 bit, doubling an unsigned int wraps to 0 before it exceeds an amdahl_max_cores above 2^31
+				for (uint64_t cores = 2; cores <= std::max(settings.amdahl_max_cores, 2u); cores *= 2)
+					amdahl.projected_speedup.emplace_back(static_cast<unsigned int>(cores), 1.0 / (amdahl.serial_fraction + (1.0 - amdahl.serial_fraction) / cores));
+
+				//serial intervals are disjoint and sorted, only one thread is inside tracked work during them
+				std::map<std::tuple<std::string_view, std::string_view, int>, uint_fast64_t> serial_time{};
+				for (const auto& [segment, e] : segments) {
+					if (e->kind == event_kind::wait)
+						continue;
+					auto it = std::upper_bound(serial_intervals.begin(), serial_intervals.end(), segment.start_time,
+						[](const time_point& t, const Simple_Event& interval) { return t < interval.end_time; });
+					for (; it != serial_intervals.end() && it->start_time < segment.end_time; ++it) {
+						const auto overlap = std::min(it->end_time, segment.end_time) - std::max(it->start_time, segment.start_time);
+						if (overlap.count() > 0)
+							serial_time[{ e->filename, e->function, e->line }] += std::chrono::duration_cast<std::chrono::nanoseconds>(overlap).count();
+					}
+				}
+				for (const auto& [key, time] : serial_time)
+					amdahl.serial_callsites.push_back({ std::get<0>(key), std::get<1>(key), std::get<2>(key), time });
+				std::sort(amdahl.serial_callsites.begin(), amdahl.serial_callsites.end(), [](const serial_callsite& a, const serial_callsite& b) {
+					return a.serial_time > b.serial_time;
+					});
+			}
+
+			template<typename StreamType>
+			void get_amdahl_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable info({ "serial fraction", "average parallelism", "serial time", "time tracked" }, use_color, alternate_colors);
+				uint_fast64_t busy = 0;
+				for (size_t k = 1; k < amdahl.time_at_concurrency.size(); k++)
+					busy += amdahl.time_at_concurrency[k];
+				std::ostringstream fraction, parallelism;
+				fraction << std::fixed << std::setprecision(2) << amdahl.serial_fraction * 100.0 << "%";
+				parallelism << std::fixed << std::setprecision(2) << amdahl.average_parallelism;
+				info.addRow({ fraction.str(), parallelism.str(),
+					BeautifulTable::table_time(amdahl.time_at_concurrency.size() > 1 ? amdahl.time_at_concurrency[1] : uint_fast64_t(0)), BeautifulTable::table_time(busy) });
+				info.print(stream);
+
+				BeautifulTable concurrency({ "threads active", "time", "time %" }, use_color, alternate_colors);
+				for (size_t k = 0; k < amdahl.time_at_concurrency.size(); k++) {
+					if (amdahl.time_at_concurrency[k] == 0)
+						continue;
+					concurrency.addRow({ BeautifulTable::table_string(k), BeautifulTable::table_time(amdahl.time_at_concurrency[k]),
+						BeautifulTable::table_percentage(amdahl.time_at_concurrency[k], time_total) });
+				}
+				concurrency.print(stream);
+
+				std::vector<std::string> header{}, row{};
+				for (const auto& [cores, speedup] : amdahl.projected_speedup) {
+					header.push_back(BeautifulTable::table_string(cores) + " cores");
+					std::ostringstream ss;
+					ss << std::fixed << std::setprecision(2) << speedup << "x";
+					row.push_back(ss.str());
+				}
+				if (header.size() > 0) {
+					BeautifulTable projection(header, use_color, alternate_colors, { {"projected speedup",static_cast<int>(header.size())} });
+					projection.addRow(row);
+					projection.print(stream);
+				}
+
+				BeautifulTable serial({ "filename", "function", "line", "serial time", "serial %" }, use_color, alternate_colors, { {"callsites dominating serial phases",5} });
+				const uint_fast64_t serial_total = amdahl.time_at_concurrency.size() > 1 ? amdahl.time_at_concurrency[1] : 0;
+				for (size_t i = 0; i < amdahl.serial_callsites.size() && i < 10; i++) {
+					const auto& entry = amdahl.serial_callsites[i];
+					serial.addRow({ BeautifulTable::stable_shortenPath(std::string(entry.filename)), std::string(entry.function), BeautifulTable::table_string(entry.line),
+						BeautifulTable::table_time(entry.serial_time), BeautifulTable::table_percentage(entry.serial_time, serial_total) });
+				}
+				serial.print(stream);
+			}
+
+			void calculate_overlap() {
+				const size_t n = std::min<size_t>(settings.overlap_top_n, sorted_events.size());
+				std::vector<std::vector<Simple_Event>> grouped(n);
+				for (size_t i = 0; i < n; i++) {
+					overlap.callsites.push_back(sorted_events[i]);
+					grouped[i] = create_thread_grouped_simple_events(sorted_events[i]->all_events);
+				}
+				overlap.matrix.assign(n * n, 0);
+				for (size_t a = 0; a < n; a++) {
+					for (size_t b = a + 1; b < n; b++) {
+						const uint_fast64_t time = cross_thread_overlap(grouped[a], grouped[b]);
+						overlap.matrix[a * n + b] = overlap.matrix[b * n + a] = time;
+						if (time > 0)
+							overlap.pairs.push_back({ a, b, time });
+					}
+				}
+				std::sort(overlap.pairs.begin(), overlap.pairs.end(), [](const callsite_overlap& x, const callsite_overlap& y) {
+					return x.overlap_time > y.overlap_time;
+					});
+			}
+
+			template<typename StreamType>
+			void get_overlap_table(StreamType& stream, bool use_color = false) const {
+				const size_t n = overlap.callsites.size();
+				if (n == 0)
+					return;
+				std::vector<std::string> header{ "#", "function", "line" };
+				for (size_t i = 0; i < n; i++)
+					header.push_back(BeautifulTable::table_string(i));
+				BeautifulTable matrix(header, use_color, alternate_colors, { {"callsite",3},{"time active concurrently on different threads",static_cast<int>(n)} });
+				for (size_t a = 0; a < n; a++) {
+					std::vector<std::string> row{ BeautifulTable::table_string(a), overlap.callsites[a]->function_name, BeautifulTable::table_string(overlap.callsites[a]->line) };
+					for (size_t b = 0; b < n; b++)
+						row.push_back(a == b ? "-" : BeautifulTable::table_time(overlap.matrix[a * n + b]));
+					matrix.addRow(row);
+				}
+				matrix.print(stream);
+
+				BeautifulTable pairs({ "function a", "line a", "function b", "line b", "overlap", "% of a active", "% of b active" }, use_color, alternate_colors,
+					{ {"most overlapping pairs",7} });
+				for (size_t i = 0; i < overlap.pairs.size() && i < 10; i++) {
+					const auto& pair = overlap.pairs[i];
+					const auto* a = overlap.callsites[pair.a];
+					const auto* b = overlap.callsites[pair.b];
+					pairs.addRow({ a->function_name, BeautifulTable::table_string(a->line), b->function_name, BeautifulTable::table_string(b->line),
+						BeautifulTable::table_time(pair.overlap_time), BeautifulTable::table_percentage(pair.overlap_time, a->all_time_active),
+						BeautifulTable::table_percentage(pair.overlap_time, b->all_time_active) });
+				}
+				pairs.print(stream);
+			}
+
+			//workers of a region instance are the threads of the spans forked from it. Unlinked threads are not attributed,
+			//they may belong to a concurrent instance or unrelated work. Children on the coordinating thread are its own work
+			void calculate_parallel_regions() {
+				std::vector<const Event*> regions{};
+				for (const auto& [uid, e] : a_events)
+					if (e.kind == event_kind::parallel_region)
+						regions.push_back(&e);
+				if (regions.size() == 0)
+					return;
+
+				auto busy_time = [](std::vector<Simple_Event>& simple) {
+					std::sort(simple.begin(), simple.end(), cmp_simple_event_by_start_time_asc);
+					return sum_field(sorted_create_grouped_simple_events(simple), &Simple_Event::duration);
+					};
+				auto clipped = [](const Event& e, const Event& region) {
+					const auto start = std::max(e.start_time, region.start_time);
+					const auto end = std::max(start, std::min(e.end_time, region.end_time));
+					return Simple_Event(start, end, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), 0);
+					};
+
+				std::map<std::tuple<std::string_view, std::string_view, int>, region_imbalance> per_callsite{};
+				for (const Event* region : regions) {
+					const auto uid = static_cast<int_fast64_t>(get_unique_event_id(region->thread_id, region->event_id));
+					std::map<int, std::vector<Simple_Event>> worker_events{};
+					auto forked = cross_child_graph.find(uid);
+					if (forked != cross_child_graph.end()) {
+						for (auto child_id : forked->second) {
+							const Event& child = a_events.at(child_id);
+							if (child.thread_id != region->thread_id)
+								worker_events[child.thread_id].push_back(clipped(child, *region));
+						}
+					}
+					if (worker_events.size() == 0)
+						continue;
+
+					region_instance instance{};
+					instance.region = region;
+					for (auto& [t_id, simple] : worker_events) {
+						const uint_fast64_t time = busy_time(simple);
+						instance.worker_time.emplace_back(t_id, time);
+						instance.max_time = std::max(instance.max_time, time);
+						instance.mean_time += static_cast<double>(time);
+					}
+					instance.mean_time /= static_cast<double>(instance.worker_time.size());
+					if (instance.mean_time > 0.0)
+						instance.imbalance = (instance.max_time / instance.mean_time - 1.0) * 100.0;
+					for (const auto& [t_id, time] : instance.worker_time)
+						if (time > instance.mean_time * (1.0 + settings.straggler_percent / 100.0))
+							instance.stragglers.push_back(t_id);
+
+					auto& entry = per_callsite[{ region->filename, region->function, region->line }];
+					entry.instances.push_back(std::move(instance));
+				}
+
+				for (auto& [key, entry] : per_callsite) {
+					entry.filename = std::get<0>(key);
+					entry.function = std::get<1>(key);
+					entry.line = std::get<2>(key);
+					const double cnt = static_cast<double>(entry.instances.size());
+					for (const auto& instance : entry.instances) {
+						entry.mean_imbalance += instance.imbalance / cnt;
+						entry.max_imbalance = std::max(entry.max_imbalance, instance.imbalance);
+						entry.mean_max_time += instance.max_time / cnt;
+						entry.mean_mean_time += instance.mean_time / cnt;
+						entry.mean_workers += instance.worker_time.size() / cnt;
+						for (int t_id : instance.stragglers)
+							entry.straggler_cnt[t_id]++;
+					}
+					parallel_regions.push_back(std::move(entry));
+				}
+				std::sort(parallel_regions.begin(), parallel_regions.end(), [](const region_imbalance& a, const region_imbalance& b) {
+					return a.mean_max_time * a.instances.size() > b.mean_max_time * b.instances.size();
+					});
+			}
+
+			template<typename StreamType>
+			void get_parallel_region_table(StreamType& stream, bool use_color = false) const {
+				for (const auto& entry : parallel_regions) {
+					std::vector<std::pair<int, unsigned int>> stragglers(entry.straggler_cnt.begin(), entry.straggler_cnt.end());
+					std::sort(stragglers.begin(), stragglers.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+					std::string straggler_str{};
+					for (size_t i = 0; i < stragglers.size() && i < 5; i++)
+						straggler_str += (i == 0 ? "" : ", ") + BeautifulTable::table_string(stragglers[i].first) + " (" + BeautifulTable::table_string(stragglers[i].second) + "x)";
+
+					std::ostringstream mean_imbalance, max_imbalance, workers;
+					mean_imbalance << std::fixed << std::setprecision(2) << entry.mean_imbalance << "%";
+					max_imbalance << std::fixed << std::setprecision(2) << entry.max_imbalance << "%";
+					workers << std::fixed << std::setprecision(1) << entry.mean_workers;
+					BeautifulTable table({ "filename", "function", "line", "instances", "workers", "max worker", "mean worker", "imbalance", "max imbalance", "straggler threads (instances)" },
+						use_color, alternate_colors, { {"parallel region",4},{"mean over instances",4},{"worst",1},{"",1} });
+					table.addRow({ BeautifulTable::stable_shortenPath(std::string(entry.filename)), std::string(entry.function), BeautifulTable::table_string(entry.line),
+						BeautifulTable::table_string(entry.instances.size()), workers.str(), BeautifulTable::table_time(entry.mean_max_time),
+						BeautifulTable::table_time(entry.mean_mean_time), mean_imbalance.str(), max_imbalance.str(), straggler_str.empty() ? "-" : straggler_str });
+					table.print(stream);
+				}
+			}
+
+			//dequeues are matched with the oldest pending enqueue of the same item id, so ids may be reused
+			void calculate_queues() {
+				std::sort(raw_queue_events.begin(), raw_queue_events.end(), [](const queue_event& a, const queue_event& b) {
+					return std::tie(a.queue, a.time, a.dequeue) < std::tie(b.queue, b.time, b.dequeue);
+					});
+				auto begin = raw_queue_events.begin();
+				while (begin != raw_queue_events.end()) {
+					auto end = std::find_if(begin, raw_queue_events.end(), [&](const queue_event& e) { return e.queue != begin->queue; });
+					queue_stats stats{};
+					stats.name = begin->queue;
+					std::unordered_map<uint_fast64_t, std::deque<std::chrono::high_resolution_clock::time_point>> pending{};
+					std::vector<uint_fast64_t> waits{};
+					std::chrono::high_resolution_clock::time_point first_enqueue = begin->time, last_dequeue = begin->time;
+					for (auto it = begin; it != end; ++it) {
+						if (!it->dequeue) {
+							stats.enqueued++;
+							pending[it->item_id].push_back(it->time);
+							continue;
+						}
+						auto item = pending.find(it->item_id);
+						if (item == pending.end() || item->second.empty())
+							continue; //enqueued before tracking started
+						waits.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(it->time - item->second.front()).count());
+						item->second.pop_front();
+						last_dequeue = it->time;
+					}
+					begin = end;
+					stats.dequeued = static_cast<unsigned int>(waits.size());
+					stats.pending = stats.enqueued - stats.dequeued;
+					if (waits.size() > 0) {
+						std::sort(waits.begin(), waits.end());
+						stats.mean_wait = std::accumulate(waits.begin(), waits.end(), 0.0) / static_cast<double>(waits.size());
+						stats.p50_wait = sorted_quantile(waits, 0.5);
+						stats.p90_wait = sorted_quantile(waits, 0.9);
+						stats.p99_wait = sorted_quantile(waits, 0.99);
+						stats.max_wait = waits.back();
+						const double seconds = std::chrono::duration<double>(last_dequeue - first_enqueue).count();
+						if (seconds > 0.0)
+							stats.throughput = stats.dequeued / seconds;
+						stats.mean_depth = stats.throughput * stats.mean_wait / 1e9;
+					}
+					queues.push_back(stats);
+				}
+				raw_queue_events.clear();
+				raw_queue_events.shrink_to_fit();
+			}
+
+			template<typename StreamType>
+			void get_queue_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "queue", "enqueued", "dequeued", "pending", "mean", "p50", "p90", "p99", "max", "items/s", "mean depth" },
+					use_color, alternate_colors, { {"",4},{"wait time",5},{"",2} });
+				for (const auto& stats : queues) {
+					std::ostringstream throughput, depth;
+					throughput << std::fixed << std::setprecision(1) << stats.throughput;
+					depth << std::fixed << std::setprecision(2) << stats.mean_depth;
+					table.addRow({ std::string(stats.name), BeautifulTable::table_string(stats.enqueued), BeautifulTable::table_string(stats.dequeued),
+						BeautifulTable::table_string(stats.pending), BeautifulTable::table_time(stats.mean_wait), BeautifulTable::table_time(stats.p50_wait),
+						BeautifulTable::table_time(stats.p90_wait), BeautifulTable::table_time(stats.p99_wait), BeautifulTable::table_time(stats.max_wait),
+						throughput.str(), depth.str() });
+				}
+				table.print(stream);
+			}
+
+			void calculate_metrics() {
+				std::map<std::tuple<std::string_view, std::string_view, int, std::string_view, bool>, std::pair<counter_stats, std::unordered_set<uint_fast64_t>>> per_callsite{};
+				std::map<std::string_view, std::vector<const metric_record*>> per_gauge{};
+				for (const auto& record : raw_metric_records) {
+					if (record.gauge) {
+						per_gauge[record.name].push_back(&record);
+						continue;
+					}
+					auto span = record.span_id != 0 ? a_events.find(static_cast<int_fast64_t>(record.span_id)) : a_events.end();
+					const bool in_span = span != a_events.end();
+					//the span of an open scope has no event yet, its callsite is unknown
+					const bool unfinished = record.span_id != 0 && !in_span;
+					auto& [stats, spans] = per_callsite[{ in_span ? span->second.filename : std::string_view{}, in_span ? span->second.function : std::string_view{},
+						in_span ? span->second.line : 0, record.name, unfinished }];
+					stats.total += record.value;
+					if (in_span)
+						spans.insert(record.span_id);
+				}
+
+				const double tracked_seconds = time_total / 1e9;
+				for (auto& [key, entry] : per_callsite) {
+					auto& [stats, spans] = entry;
+					std::tie(stats.filename, stats.function, stats.line, stats.name, stats.unfinished) = key;
+					stats.spans = static_cast<unsigned int>(spans.size());
+					double seconds = tracked_seconds;
+					if (stats.spans > 0) {
+						stats.per_call = stats.total / stats.spans;
+						seconds = f_res.at(stats.filename).at(stats.function).at(stats.line).all_time_active / 1e9;
+					}
+					if (seconds > 0.0)
+						stats.rate = stats.total / seconds;
+					counters.push_back(stats);
+				}
+				std::sort(counters.begin(), counters.end(), [](const counter_stats& a, const counter_stats& b) { return std::tie(a.name, a.total) < std::tie(b.name, b.total); });
+
+				for (auto& [name, records] : per_gauge) {
+					std::sort(records.begin(), records.end(), [](const metric_record* a, const metric_record* b) { return a->time < b->time; });
+					gauge_stats stats{};
+					stats.name = name;
+					stats.samples = static_cast<unsigned int>(records.size());
+					stats.min = stats.max = records[0]->value;
+					double weighted = 0.0;
+					for (size_t i = 0; i < records.size(); i++) {
+						stats.min = std::min(stats.min, records[i]->value);
+						stats.max = std::max(stats.max, records[i]->value);
+						stats.mean += records[i]->value / records.size();
+						if (i + 1 < records.size())
+							weighted += records[i]->value * std::chrono::duration<double>(records[i + 1]->time - records[i]->time).count();
+					}
+					const double span = std::chrono::duration<double>(records.back()->time - records.front()->time).count();
+					stats.time_weighted_mean = span > 0.0 ? weighted / span : stats.mean;
+					stats.last = records.back()->value;
+					gauges.push_back(stats);
+				}
+				raw_metric_records.clear();
+				raw_metric_records.shrink_to_fit();
+			}
+
+			template<typename StreamType>
+			void get_counter_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "filename", "function", "line", "counter", "calls", "total", "per call", "per second active" },
+					use_color, alternate_colors, { {"enclosing span",3},{"",5} });
+				for (const auto& stats : counters) {
+					table.addRow({ stats.spans > 0 ? BeautifulTable::stable_shortenPath(std::string(stats.filename)) : "-",
+						stats.spans > 0 ? std::string(stats.function) : (stats.unfinished ? "(unfinished span)" : "-"),
+						stats.spans > 0 ? BeautifulTable::table_string(stats.line) : "-", std::string(stats.name), BeautifulTable::table_string(stats.spans),
+						BeautifulTable::table_quantity(stats.total), stats.spans > 0 ? BeautifulTable::table_quantity(stats.per_call) : "-", BeautifulTable::table_quantity(stats.rate) + "/s" });
+				}
+				table.print(stream);
+			}
+
+			template<typename StreamType>
+			void get_gauge_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "gauge", "samples", "min", "mean", "max", "time weighted mean", "last" }, use_color, alternate_colors);
+				for (const auto& stats : gauges) {
+					table.addRow({ std::string(stats.name), BeautifulTable::table_string(stats.samples), BeautifulTable::table_quantity(stats.min),
+						BeautifulTable::table_quantity(stats.mean), BeautifulTable::table_quantity(stats.max),
+						BeautifulTable::table_quantity(stats.time_weighted_mean), BeautifulTable::table_quantity(stats.last) });
+				}
+				table.print(stream);
+			}
+
+			void calculate_arg_scaling() {
+				for (auto* entry : sorted_events) {
+					std::vector<std::pair<double, uint_fast64_t>> samples{};
+					for (const auto& e : entry->all_events) {
+						auto arg = span_arg_map.find(get_unique_event_id(e.thread_id, e.event_id));
+						if (arg != span_arg_map.end())
+							samples.emplace_back(arg->second, std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count());
+					}
+					if (samples.size() > 0)
+						entry->args = create_arg_scaling(samples);
+				}
+			}
+
+			void calculate_batches() {
+				for (const auto* entry : sorted_events) {
+					std::vector<std::pair<double, uint_fast64_t>> per_item{}; //per item latency, items
+					batch_stats stats{};
+					double total_time = 0.0;
+					for (const auto& e : entry->all_events) {
+						auto count = batch_count_map.find(get_unique_event_id(e.thread_id, e.event_id));
+						if (e.kind != event_kind::batch || count == batch_count_map.end() || count->second == 0)
+							continue;
+						const double duration = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count());
+						per_item.emplace_back(duration / count->second, count->second);
+						stats.batches++;
+						stats.items += count->second;
+						total_time += duration;
+					}
+					if (stats.batches == 0)
+						continue;
+					std::sort(per_item.begin(), per_item.end());
+					stats.filename = entry->all_events[0].filename;
+					stats.function = entry->all_events[0].function;
+					stats.line = entry->line;
+					stats.mean_items = static_cast<double>(stats.items) / stats.batches;
+					stats.item_mean = total_time / stats.items;
+					if (entry->all_time_active > 0)
+						stats.items_per_second = stats.items / (entry->all_time_active / 1e9);
+
+					const double total_items = static_cast<double>(stats.items);
+					auto weighted_quantile = [&](double q) {
+						double cumulative = 0.0;
+						for (const auto& [latency, items] : per_item) {
+							cumulative += items;
+							if (cumulative >= q * total_items)
+								return latency;
+						}
+						return per_item.back().first;
+						};
+					//mean per item latency of the items ranked between lower and upper, batches are split at the edges
+					auto weighted_band_mean = [&](double lower, double upper) {
+						double cumulative = 0.0, sum = 0.0;
+						for (const auto& [latency, items] : per_item) {
+							const double overlap = std::min(cumulative + items, upper) - std::max(cumulative, lower);
+							if (overlap > 0.0)
+								sum += overlap * latency;
+							cumulative += items;
+						}
+						return upper > lower ? sum / (upper - lower) : 0.0;
+						};
+					stats.item_p50 = weighted_quantile(0.5);
+					stats.item_p90 = weighted_quantile(0.9);
+					stats.item_p99 = weighted_quantile(0.99);
+					const double band = total_items * settings.non_center_percent / 100.0;
+					stats.fastest_item_mean = weighted_band_mean(0.0, std::max(band, 1.0));
+					stats.slowest_item_mean = weighted_band_mean(total_items - std::max(band, 1.0), total_items);
+					batches.push_back(stats);
+				}
+			}
+
+			template<typename StreamType>
+			void get_batch_table(StreamType& stream, bool use_color = false) const {
+				const std::string fastest = "fastest[0-" + std::to_string(settings.non_center_percent) + "]";
+				const std::string slowest = "slowest[" + std::to_string(100 - settings.non_center_percent) + "-100]";
+				BeautifulTable table({ "filename", "function", "line", "batches", "items", "items/batch", "mean", fastest, "p50", "p90", "p99", slowest, "items/s" },
+					use_color, alternate_colors, { {"batch",6},{"per item latency",6},{"",1} });
+				for (const auto& stats : batches) {
+					table.addRow({ BeautifulTable::stable_shortenPath(std::string(stats.filename)), std::string(stats.function), BeautifulTable::table_string(stats.line),
+						BeautifulTable::table_string(stats.batches), BeautifulTable::table_quantity(static_cast<double>(stats.items)), BeautifulTable::table_quantity(stats.mean_items),
+						BeautifulTable::table_time(stats.item_mean), BeautifulTable::table_time(stats.fastest_item_mean), BeautifulTable::table_time(stats.item_p50),
+						BeautifulTable::table_time(stats.item_p90), BeautifulTable::table_time(stats.item_p99), BeautifulTable::table_time(stats.slowest_item_mean),
+						BeautifulTable::table_quantity(stats.items_per_second) });
+				}
+				table.print(stream);
+			}
+
+			//locks are told apart by their construction site, holders by the CTRACK_LOCK site or the span that took the lock
+			void calculate_locks() {
+				std::map<std::tuple<std::string_view, int, std::string_view>, std::vector<const lock_event*>> per_lock{};
+				for (const auto& e : raw_lock_events)
+					per_lock[{ e.filename, e.line, e.name }].push_back(&e);
+
+				for (const auto& [key, events] : per_lock) {
+					lock_stats stats{};
+					std::tie(stats.filename, stats.line, stats.name) = key;
+					std::vector<uint_fast64_t> waits{}, holds{};
+					std::map<std::tuple<std::string_view, std::string_view, int>, lock_holder> holders{};
+					for (const auto* e : events) {
+						const uint_fast64_t hold = std::chrono::duration_cast<std::chrono::nanoseconds>(e->released - e->acquired).count();
+						stats.acquisitions++;
+						stats.shared_acquisitions += e->shared ? 1 : 0;
+						if (e->contended) {
+							stats.contended++;
+							waits.push_back(e->wait);
+						}
+						stats.wait_time += e->wait;
+						stats.hold_time += hold;
+						holds.push_back(hold);
+
+						auto span = e->holder_id != 0 ? a_events.find(static_cast<int_fast64_t>(e->holder_id)) : a_events.end();
+						auto& holder = !e->site_function.empty() ? holders[{ e->site_filename, e->site_function, e->site_line }] :
+							span != a_events.end() ? holders[{ span->second.filename, span->second.function, span->second.line }] : holders[{}];
+						holder.acquisitions++;
+						holder.contended += e->contended ? 1 : 0;
+						holder.wait_time += e->wait;
+						holder.hold_time += hold;
+						holder.max_hold = std::max(holder.max_hold, hold);
+					}
+					stats.contention_rate = stats.contended * 100.0 / stats.acquisitions;
+					if (waits.size() > 0) {
+						std::sort(waits.begin(), waits.end());
+						stats.wait_p50 = sorted_quantile(waits, 0.5);
+						stats.wait_p90 = sorted_quantile(waits, 0.9);
+						stats.wait_p99 = sorted_quantile(waits, 0.99);
+						stats.wait_max = waits.back();
+					}
+					std::sort(holds.begin(), holds.end());
+					stats.hold_mean = static_cast<double>(stats.hold_time) / stats.acquisitions;
+					stats.hold_p99 = sorted_quantile(holds, 0.99);
+					for (auto& [holder_key, holder] : holders) {
+						std::tie(holder.filename, holder.function, holder.line) = holder_key;
+						stats.holders.push_back(holder);
+					}
+					std::sort(stats.holders.begin(), stats.holders.end(), [](const lock_holder& a, const lock_holder& b) {
+						return a.wait_time > b.wait_time || (a.wait_time == b.wait_time && a.hold_time > b.hold_time); });
+					locks.push_back(std::move(stats));
+				}
+				std::sort(locks.begin(), locks.end(), [](const lock_stats& a, const lock_stats& b) { return a.wait_time > b.wait_time; });
+				raw_lock_events.clear();
+				raw_lock_events.shrink_to_fit();
+			}
+
+			template<typename StreamType>
+			void get_lock_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "lock", "line", "acquired", "shared", "contended", "wait total", "p50", "p90", "p99", "max", "hold total", "mean", "p99" },
+					use_color, alternate_colors, { {"",5},{"wait",5},{"hold",3} });
+				for (const auto& stats : locks) {
+					const std::string name = stats.name.empty() ? BeautifulTable::stable_shortenPath(std::string(stats.filename)) : std::string(stats.name);
+					table.addRow({ name, BeautifulTable::table_string(stats.line), BeautifulTable::table_string(stats.acquisitions),
+						BeautifulTable::table_string(stats.shared_acquisitions), BeautifulTable::table_percentage(stats.contended, stats.acquisitions),
+						BeautifulTable::table_time(stats.wait_time), BeautifulTable::table_time(stats.wait_p50), BeautifulTable::table_time(stats.wait_p90),
+						BeautifulTable::table_time(stats.wait_p99), BeautifulTable::table_time(stats.wait_max), BeautifulTable::table_time(stats.hold_time),
+						BeautifulTable::table_time(stats.hold_mean), BeautifulTable::table_time(stats.hold_p99) });
+				}
+				table.print(stream);
+
+				BeautifulTable holder_table({ "lock", "filename", "function", "line", "acquired", "contended", "wait total", "hold total", "hold mean", "hold max" },
+					use_color, default_colors, { {"",1},{"locking callsites",9} });
+				for (const auto& stats : locks) {
+					const std::string name = stats.name.empty() ? BeautifulTable::stable_shortenPath(std::string(stats.filename)) + ":" + std::to_string(stats.line) : std::string(stats.name);
+					for (size_t i = 0; i < stats.holders.size() && i < 5; i++) {
+						const auto& holder = stats.holders[i];
+						const bool in_span = !holder.function.empty();
+						holder_table.addRow({ name, in_span ? BeautifulTable::stable_shortenPath(std::string(holder.filename)) : "-", in_span ? std::string(holder.function) : "-",
+							in_span ? BeautifulTable::table_string(holder.line) : "-", BeautifulTable::table_string(holder.acquisitions),
+							BeautifulTable::table_percentage(holder.contended, holder.acquisitions), BeautifulTable::table_time(holder.wait_time), BeautifulTable::table_time(holder.hold_time),
+							BeautifulTable::table_time(static_cast<double>(holder.hold_time) / holder.acquisitions), BeautifulTable::table_time(holder.max_hold) });
+					}
+				}
+				holder_table.print(stream);
+			}
+
+			//exclusive time per callsite of a frame and all its descendants, forked work included. It is the "time ae" of the
+			//detail table restricted to the frame: the merged spans of a callsite minus their merged children on the same thread
+			void add_frame_breakdown(const Event& frame, std::map<std::tuple<std::string_view, std::string_view, int>, uint_fast64_t>& breakdown) const {
+				std::map<std::tuple<std::string_view, std::string_view, int>, std::vector<Simple_Event>> per_callsite{};
+				std::vector<const Event*> stack{ &frame };
+				while (stack.size() > 0) {
+					const Event* e = stack.back();
+					stack.pop_back();
+					const auto uid = static_cast<int_fast64_t>(get_unique_event_id(e->thread_id, e->event_id));
+					per_callsite[{ e->filename, e->function, e->line }].emplace_back(e->start_time, e->end_time,
+						std::chrono::duration_cast<std::chrono::nanoseconds>(e->end_time - e->start_time).count(), uid);
+					auto children = child_graph.find(uid);
+					if (children != child_graph.end()) {
+						for (auto child_id : children->second)
+							stack.push_back(&a_events.at(child_id));
+					}
+					auto cross_children = cross_child_graph.find(uid);
+					if (cross_children != cross_child_graph.end()) {
+						for (auto child_id : cross_children->second)
+							stack.push_back(&a_events.at(child_id));
+					}
+				}
+				for (auto& [key, events] : per_callsite) {
+					auto child_events = load_child_events_simple(events, a_events, child_graph, cross_child_graph);
+					std::sort(events.begin(), events.end(), cmp_simple_event_by_start_time_asc);
+					std::sort(child_events.begin(), child_events.end(), cmp_simple_event_by_start_time_asc);
+					const uint_fast64_t active = sum_field(sorted_create_grouped_simple_events(events), &Simple_Event::duration);
+					const uint_fast64_t children_time = sum_field(sorted_create_grouped_simple_events(child_events), &Simple_Event::duration);
+					breakdown[key] += active > children_time ? active - children_time : 0;
+				}
+			}
+
+			void calculate_frames() {
+				for (const auto* entry : sorted_events) {
+					if (entry->all_events.size() == 0 || entry->all_events[0].kind != event_kind::frame)
+						continue;
+					frame_stats stats{};
+					stats.filename = entry->all_events[0].filename;
+					stats.function = entry->all_events[0].function;
+					stats.line = entry->line;
+					stats.cnt = entry->all_cnt;
+					stats.mean = entry->all_mean;
+
+					std::vector<uint_fast64_t> durations{};
+					for (const auto& e : entry->all_events)
+						durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count());
+					std::sort(durations.begin(), durations.end());
+					stats.p50 = sorted_quantile(durations, 0.5);
+					stats.p90 = sorted_quantile(durations, 0.9);
+					stats.p99 = sorted_quantile(durations, 0.99);
+					stats.max = durations.back();
+					stats.slow_threshold = sorted_quantile(durations, settings.frame_slow_percentile / 100.0);
+
+					std::map<std::tuple<std::string_view, std::string_view, int>, uint_fast64_t> slow{}, typical{};
+					for (const auto& e : entry->all_events) {
+						const double duration = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count());
+						const bool is_slow = duration >= stats.slow_threshold;
+						(is_slow ? stats.slow_mean : stats.typical_mean) += duration;
+						stats.slow_cnt += is_slow ? 1 : 0;
+						add_frame_breakdown(e, is_slow ? slow : typical);
+					}
+					const unsigned int typical_cnt = stats.cnt - stats.slow_cnt;
+					stats.slow_mean = stats.slow_cnt > 0 ? stats.slow_mean / stats.slow_cnt : 0.0;
+					stats.typical_mean = typical_cnt > 0 ? stats.typical_mean / typical_cnt : 0.0;
+
+					std::map<std::tuple<std::string_view, std::string_view, int>, frame_breakdown_entry> breakdown{};
+					for (const auto& [key, time] : slow)
+						breakdown[key].slow_time = stats.slow_cnt > 0 ? static_cast<double>(time) / stats.slow_cnt : 0.0;
+					for (const auto& [key, time] : typical)
+						breakdown[key].typical_time = typical_cnt > 0 ? static_cast<double>(time) / typical_cnt : 0.0;
+					for (auto& [key, value] : breakdown) {
+						std::tie(value.filename, value.function, value.line) = key;
+						stats.breakdown.push_back(value);
+					}
+					std::sort(stats.breakdown.begin(), stats.breakdown.end(), [](const frame_breakdown_entry& a, const frame_breakdown_entry& b) {
+						return a.slow_time - a.typical_time > b.slow_time - b.typical_time;
+						});
+					frames.push_back(std::move(stats));
+				}
+			}
+
+			template<typename StreamType>
+			void get_frame_table(StreamType& stream, bool use_color = false) const {
+				std::ostringstream percentile;
+				percentile << settings.frame_slow_percentile;
+				for (const auto& stats : frames) {
+					BeautifulTable table({ "filename", "function", "line", "frames", "mean", "p50", "p90", "p99", "max", "slow frames", "slow mean", "typical mean" },
+						use_color, alternate_colors, { {"frame",4},{"duration",5},{"slow: >= p" + percentile.str(),3} });
+					table.addRow({ BeautifulTable::stable_shortenPath(std::string(stats.filename)), std::string(stats.function), BeautifulTable::table_string(stats.line),
+						BeautifulTable::table_string(stats.cnt), BeautifulTable::table_time(stats.mean), BeautifulTable::table_time(stats.p50),
+						BeautifulTable::table_time(stats.p90), BeautifulTable::table_time(stats.p99), BeautifulTable::table_time(stats.max),
+						BeautifulTable::table_string(stats.slow_cnt), BeautifulTable::table_time(stats.slow_mean), BeautifulTable::table_time(stats.typical_mean) });
+					table.print(stream);
+
+					BeautifulTable breakdown({ "filename", "function", "line", "slow frame", "typical frame", "difference", "change" }, use_color, default_colors,
+						{ {"exclusive time per frame",7} });
+					for (const auto& entry : stats.breakdown) {
+						breakdown.addRow({ BeautifulTable::stable_shortenPath(std::string(entry.filename)), std::string(entry.function), BeautifulTable::table_string(entry.line),
+							BeautifulTable::table_time(entry.slow_time), BeautifulTable::table_time(entry.typical_time),
+							BeautifulTable::table_signed_time(entry.slow_time - entry.typical_time), BeautifulTable::table_change(entry.slow_time, entry.typical_time) });
+					}
+					breakdown.print(stream);
+				}
+			}
+
+			template<typename StreamType>
+			void get_wait_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "filename", "function", "line", "calls", "threads", "mean", "median", "max", "time waited", "time a" },
+					use_color, alternate_colors, { {"wait",5},{"per call",3},{"total",2} });
+				for (const auto* entry : wait_events) {
+					table.addRow({ BeautifulTable::stable_shortenPath(entry->filename), entry->function_name, BeautifulTable::table_string(entry->line),
+						BeautifulTable::table_string(entry->all_cnt), BeautifulTable::table_string(entry->all_thread_cnt), BeautifulTable::table_time(entry->all_mean),
+						BeautifulTable::table_time(entry->all_med), BeautifulTable::table_time(entry->slowest_max > 0 ? entry->slowest_max : entry->center_max),
+						BeautifulTable::table_time(entry->all_time_acc), BeautifulTable::table_time(entry->all_time_active) });
+				}
+				table.print(stream);
+			}
+
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			//slowest spans that moved to another cpu while running, relative to the median of their callsite
+			void calculate_migrations() {
+				for (const auto* entry : sorted_events) {
+					if (entry->migrations == 0)
+						continue;
+					for (const auto& e : entry->all_events) {
+						if (e.start_cpu == unknown_cpu || e.end_cpu == unknown_cpu || e.start_cpu == e.end_cpu)
+							continue;
+						const uint_fast64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count();
+						migrated_spans.push_back({ entry, &e, duration });
+					}
+				}
+				std::sort(migrated_spans.begin(), migrated_spans.end(), [](const migrated_span& a, const migrated_span& b) { return a.duration > b.duration; });
+				if (migrated_spans.size() > settings.migration_outliers)
+					migrated_spans.resize(settings.migration_outliers);
+			}
+
+			template<typename StreamType>
+			void get_migration_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "filename", "function", "line", "thread", "start cpu", "end cpu", "time", "callsite median", "x median", "migrated calls" },
+					use_color, alternate_colors, { {"migrated span",6},{"duration",3},{"",1} });
+				for (const auto& span : migrated_spans) {
+					std::ostringstream ratio;
+					ratio << std::fixed << std::setprecision(2) << (span.group->all_med > 0.0 ? span.duration / span.group->all_med : 0.0);
+					table.addRow({ BeautifulTable::stable_shortenPath(span.group->filename), span.group->function_name, BeautifulTable::table_string(span.group->line),
+						BeautifulTable::table_string(span.event->thread_id), BeautifulTable::table_string(span.event->start_cpu), BeautifulTable::table_string(span.event->end_cpu),
+						BeautifulTable::table_time(span.duration), BeautifulTable::table_time(span.group->all_med), ratio.str(),
+						BeautifulTable::table_percentage(span.group->migrations, span.group->all_cnt) });
+				}
+				table.print(stream);
+			}
+#endif
+
+			void calculate_coroutines() {
+				for (const auto* entry : sorted_events) {
+					coroutine_stats stats{};
+					for (const auto& e : entry->all_events) {
+						auto record = coroutine_record_map.find(static_cast<int_fast64_t>(get_unique_event_id(e.thread_id, e.event_id)));
+						if (e.kind != event_kind::coroutine || record == coroutine_record_map.end())
+							continue;
+						const uint_fast64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count();
+						const uint_fast64_t active = std::min(record->second.active_time, time);
+						stats.cnt++;
+						stats.mean_time += static_cast<double>(time);
+						stats.mean_active += static_cast<double>(active);
+						stats.max_suspended = std::max(stats.max_suspended, time - active);
+						stats.mean_suspensions += record->second.suspensions;
+					}
+					if (stats.cnt == 0)
+						continue;
+					stats.filename = entry->all_events[0].filename;
+					stats.function = entry->all_events[0].function;
+					stats.line = entry->line;
+					stats.mean_time /= stats.cnt;
+					stats.mean_active /= stats.cnt;
+					stats.mean_suspended = stats.mean_time - stats.mean_active;
+					stats.mean_suspensions /= stats.cnt;
+					coroutines.push_back(stats);
+				}
+			}
+
+			template<typename StreamType>
+			void get_coroutine_table(StreamType& stream, bool use_color = false) const {
+				BeautifulTable table({ "filename", "function", "line", "calls", "time", "active", "suspended", "suspended %", "suspensions", "max suspended" },
+					use_color, alternate_colors, { {"coroutine",4},{"mean",5},{"",1} });
+				for (const auto& stats : coroutines) {
+					std::ostringstream suspended_percent, suspensions;
+					suspended_percent << std::fixed << std::setprecision(2) << (stats.mean_time > 0.0 ? stats.mean_suspended / stats.mean_time * 100.0 : 0.0) << "%";
+					suspensions << std::fixed << std::setprecision(1) << stats.mean_suspensions;
+					table.addRow({ BeautifulTable::stable_shortenPath(std::string(stats.filename)), std::string(stats.function), BeautifulTable::table_string(stats.line),
+						BeautifulTable::table_string(stats.cnt), BeautifulTable::table_time(stats.mean_time), BeautifulTable::table_time(stats.mean_active),
+						BeautifulTable::table_time(stats.mean_suspended), suspended_percent.str(), suspensions.str(), BeautifulTable::table_time(stats.max_suspended) });
+				}
+				table.print(stream);
+			}
+
+			void calculate_stats() {
+				std::vector<Simple_Event> grouped_events{};
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				const std::map<int, int> cpu_nodes = create_cpu_numa_nodes(a_events);
+#else
+				const std::map<int, int> cpu_nodes{};
+#endif
+				for (auto& [filename, filename_entry] : f_res)
+				{
+					ctracked_files++;
+					for (auto& [function, function_entry] : filename_entry) {
+						ctracked_functions++;
+						for (auto& [line, line_entry] : function_entry) {
+							ctracked_uses++;
+							line_entry.filename = filename;
+							line_entry.function_name = function;
+							line_entry.line = line;
+							line_entry.calculateStats(settings, a_events, child_graph, cross_child_graph, cpu_nodes);
+							if (line_entry.all_events.size() > 0 && line_entry.all_events[0].kind == event_kind::wait) {
+								wait_events.push_back(&line_entry);
+								continue;
+							}
+							sorted_events.push_back(&line_entry);
+							grouped_events.insert(grouped_events.end(), line_entry.all_grouped.begin(), line_entry.all_grouped.end());
+						}
+					}
+				}
+
+				std::sort(OPT_EXEC_POLICY grouped_events.begin(), grouped_events.end(), cmp_simple_event_by_start_time_asc);
+				auto all_grouped = sorted_create_grouped_simple_events(grouped_events);
+				sum_time_active_exclusive = sum_field(all_grouped, &Simple_Event::duration);
+
+				order_pointer_vector_by_field(sorted_events, &EventGroup::all_time_active_exclusive, false);
+				order_pointer_vector_by_field(wait_events, &EventGroup::all_time_acc, false);
+
+				if (settings.critical_path)
+					calculate_critical_path();
+				if (settings.amdahl_analysis)
+					calculate_amdahl();
+				if (settings.overlap_top_n > 0)
+					calculate_overlap();
+				calculate_parallel_regions();
+				if (coroutine_record_map.size() > 0)
+					calculate_coroutines();
+				if (raw_queue_events.size() > 0)
+					calculate_queues();
+				if (raw_metric_records.size() > 0)
+					calculate_metrics();
+				if (span_arg_map.size() > 0)
+					calculate_arg_scaling();
+				if (batch_count_map.size() > 0)
+					calculate_batches();
+				if (raw_lock_events.size() > 0)
+					calculate_locks();
+				calculate_frames();
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				if (settings.migration_outliers > 0)
+					calculate_migrations();
+#endif
+
+				int fastest_events = static_cast<int>(sorted_events.size() * settings.percent_exclude_fastest_active_exclusive / 100);
+				//remove fastest keep in mind fastest elements are at the back
+				if (fastest_events > 0)
+					sorted_events.erase(sorted_events.end() - fastest_events, sorted_events.end());
+
+				uint_fast64_t min_time_active_exclusive = static_cast<uint_fast64_t>(time_total * settings.min_percent_active_exclusive / 100);
+				//remove fastest keep in mind fastest elements are at the back
+				if (min_time_active_exclusive > 0)
+					sorted_events.erase(std::remove_if(sorted_events.begin(), sorted_events.end(), [min_time_active_exclusive](EventGroup* e) {return e->all_time_active_exclusive < min_time_active_exclusive; }), sorted_events.end());
+
+			}
+
+			void reserve_a_events(size_t size) {
+				a_events.reserve(size);
+			}
+
+			inline void add_event(const std::string_view& filename, const std::string_view function, const int line, const Event& e) {
+				f_res[filename][function][line].all_events.push_back(e);
+				a_events.insert({ get_unique_event_id(e.thread_id, e.event_id), e });
+			}
+
+			void add_span_links(const span_links& links) {
+				for (const auto& link : links) {
+					cross_child_graph[link.parent_id].push_back(static_cast<int_fast64_t>(link.child_id));
+				}
+			}
+
+			void add_coroutine_records(const coroutine_records& records) {
+				for (const auto& record : records) {
+					coroutine_record_map.insert({ static_cast<int_fast64_t>(record.uid), record });
+				}
+			}
+
+			void add_queue_events(const queue_events& events) {
+				raw_queue_events.insert(raw_queue_events.end(), events.begin(), events.end());
+			}
+
+			void add_metric_records(const metric_records& records) {
+				raw_metric_records.insert(raw_metric_records.end(), records.begin(), records.end());
+			}
+
+			void add_span_args(const span_args& args) {
+				for (const auto& arg : args) {
+					span_arg_map[arg.event_uid] = arg.value;
+				}
+			}
+
+			void add_batch_counts(const batch_counts& counts, const unsigned int thread_id_) {
+				for (const auto& count : counts) {
+					batch_count_map[get_unique_event_id(thread_id_, count.event_id)] = count.items;
+				}
+			}
+
+			void add_lock_events(const lock_events& events) {
+				raw_lock_events.insert(raw_lock_events.end(), events.begin(), events.end());
+			}
+
+			void add_sub_events(const sub_events& s_events, const unsigned int thread_id_) {
+
+				for (auto const& [key, val] : s_events)
+				{
+					int_fast64_t parent_id = get_unique_event_id(thread_id_, key);
+					for (const auto& child : val) {
+						child_graph[parent_id].push_back(get_unique_event_id(thread_id_, child));
+					}
+				}
+			}
+
+			std::unordered_map < int_fast64_t, Event> a_events{};
+			filename_result f_res{};
+
+			std::unordered_map< int_fast64_t, std::vector< int_fast64_t>> child_graph{};
+			std::unordered_map< int_fast64_t, std::vector< int_fast64_t>> cross_child_graph{}; //links recorded with mark_fork/forked_scope
+			critical_path_result critical_path{}; //only with critical_path enabled
+			amdahl_result amdahl{}; //only with amdahl_analysis enabled
+			overlap_result overlap{}; //only with overlap_top_n > 0
+			std::vector<region_imbalance> parallel_regions{}; //CTRACK_PARALLEL_REGION load imbalance
+			std::unordered_map<int_fast64_t, coroutine_record> coroutine_record_map{};
+			std::vector<coroutine_stats> coroutines{}; //CTRACK_CORO active and suspended time per callsite
+			std::vector<queue_event> raw_queue_events{};
+			std::vector<queue_stats> queues{}; //CTRACK_ENQUEUE / CTRACK_DEQUEUE wait times per queue
+			std::vector<metric_record> raw_metric_records{};
+			std::unordered_map<uint_fast64_t, double> span_arg_map{};
+			std::unordered_map<uint_fast64_t, uint_fast64_t> batch_count_map{};
+			std::vector<batch_stats> batches{}; //CTRACK_BATCH per item latencies per callsite
+			std::vector<lock_event> raw_lock_events{};
+			std::vector<lock_stats> locks{}; //tracked_mutex / tracked_shared_mutex, most waited on first
+			std::vector<frame_stats> frames{}; //CTRACK_FRAME duration distribution and slow frame breakdown
+			std::vector<counter_stats> counters{}; //CTRACK_COUNT totals per callsite of the enclosing span
+			std::vector<gauge_stats> gauges{}; //CTRACK_GAUGE
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			std::vector<migrated_span> migrated_spans{}; //slowest spans that changed cpu, longest first
+#endif
+			ctrack_result_settings settings;
+			std::chrono::high_resolution_clock::time_point track_start_time, track_end_time;
+			uint_fast64_t time_total;
+			uint_fast64_t sum_time_active_exclusive = 0;
+
+			uint_fast64_t ctracked_files = 0;
+			uint_fast64_t ctracked_functions = 0;
+			uint_fast64_t ctracked_uses = 0;
+
+			std::vector<EventGroup*> sorted_events{};
+			std::vector<EventGroup*> wait_events{}; //CTRACK_WAIT callsites, not part of sorted_events
+			std::string center_intervall_str;
+		};
+
+		struct snapshot_entry {
+			std::string filename = {};
+			std::string function_name = {};
+			int line = 0;
+			uint_fast64_t time_active = 0;
+			uint_fast64_t time_active_exclusive = 0;
+			std::vector<uint_fast64_t> durations = {}; //sorted ascending
+		};
+
+		struct ctrack_snapshot {
+			uint_fast64_t time_total = 0;
+			std::vector<snapshot_entry> entries = {};
+		};
+
+		inline ctrack_snapshot make_snapshot(const ctrack_result& res) {
+			ctrack_snapshot snapshot{};
+			snapshot.time_total = res.time_total;
+			for (const auto& [filename, filename_entry] : res.f_res) {
+				for (const auto& [function, function_entry] : filename_entry) {
+					for (const auto& [line, line_entry] : function_entry) {
+						snapshot_entry entry{};
+						entry.filename = std::string(filename);
+						entry.function_name = std::string(function);
+						entry.line = line;
+						entry.time_active = line_entry.all_time_active;
+						entry.time_active_exclusive = line_entry.all_time_active_exclusive;
+						entry.durations.resize(line_entry.all_events.size());
+						std::transform(OPT_EXEC_POLICY line_entry.all_events.begin(), line_entry.all_events.end(), entry.durations.begin(),
+							[](const Event& e) {
+								return static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(e.end_time - e.start_time).count());
+							});
+						std::sort(OPT_EXEC_POLICY entry.durations.begin(), entry.durations.end());
+						snapshot.entries.push_back(std::move(entry));
+					}
+				}
+			}
+			return snapshot;
+		}
+
+		//file and function names may contain the tab and newline separators of the snapshot format
+		inline std::string escape_snapshot_field(const std::string& field) {
+			std::string res{};
+			res.reserve(field.size());
+			for (char c : field) {
+				switch (c) {
+				case '\\': res += "\\\\"; break;
+				case '\t': res += "\\t"; break;
+				case '\n': res += "\\n"; break;
+				case '\r': res += "\\r"; break;
+				default: res += c;
+				}
+			}
+			return res;
+		}
+
+		inline std::string unescape_snapshot_field(const std::string& field) {
+			std::string res{};
+			res.reserve(field.size());
+			for (size_t i = 0; i < field.size(); i++) {
+				if (field[i] != '\\' || i + 1 == field.size()) {
+					res += field[i];
+					continue;
+				}
+				switch (field[++i]) {
+				case 't': res += '\t'; break;
+				case 'n': res += '\n'; break;
+				case 'r': res += '\r'; break;
+				default: res += field[i];
+				}
+			}
+			return res;
+		}
+
+		inline void save_snapshot(const ctrack_snapshot& snapshot, const std::string& path) {
+			std::ofstream file(path);
+			if (!file) {
+				throw std::runtime_error("ctrack: could not open snapshot file for writing: " + path);
+			}
+			file << "ctrack_snapshot 2\n" << snapshot.time_total << " " << snapshot.entries.size() << "\n";
+			for (const auto& entry : snapshot.entries) {
+				file << entry.line << "\t" << entry.time_active << "\t" << entry.time_active_exclusive << "\t" << entry.durations.size()
+					<< "\t" << escape_snapshot_field(entry.filename) << "\t" << escape_snapshot_field(entry.function_name) << "\n";
+				for (size_t i = 0; i < entry.durations.size(); i++) {
+					file << (i == 0 ? "" : " ") << entry.durations[i];
+				}
+				file << "\n";
+			}
+		}
+
+		inline ctrack_snapshot load_snapshot(const std::string& path) {
+			std::ifstream file(path);
+			std::string magic;
+			int version = 0;
+			//version 1 wrote the names unescaped
+			if (!file || !(file >> magic >> version) || magic != "ctrack_snapshot" || (version != 1 && version != 2)) {
+				throw std::runtime_error("ctrack: not a valid snapshot file: " + path);
+			}
+			ctrack_snapshot snapshot{};
+			size_t entry_cnt = 0;
+			file >> snapshot.time_total >> entry_cnt;
+			file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			for (size_t i = 0; i < entry_cnt && file; i++) {
+				snapshot_entry entry{};
+				size_t duration_cnt = 0;
+				std::string header;
+				std::getline(file, header);
+				std::istringstream header_stream(header);
+				header_stream >> entry.line >> entry.time_active >> entry.time_active_exclusive >> duration_cnt;
+				header_stream.ignore(1);
+				std::getline(header_stream, entry.filename, '\t');
+				std::getline(header_stream, entry.function_name);
+				if (version >= 2) {
+					entry.filename = unescape_snapshot_field(entry.filename);
+					entry.function_name = unescape_snapshot_field(entry.function_name);
+				}
+				entry.durations.resize(duration_cnt);
+				for (auto& duration : entry.durations) {
+					file >> duration;
+				}
+				file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+				snapshot.entries.push_back(std::move(entry));
+			}
+			if (!file) {
+				throw std::runtime_error("ctrack: truncated snapshot file: " + path);
+			}
+			return snapshot;
+		}
+
+		enum class callsite_status : uint8_t {
+			both = 0, //called in baseline and current
+			added = 1, //only called in current
+			removed = 2, //only called in baseline
+		};
+
+		struct callsite_comparison {
+			std::string filename = {};
+			std::string function_name = {};
+			int line = 0;
+
+			unsigned int baseline_cnt = 0;
+			unsigned int current_cnt = 0;
+			double baseline_mean = 0.0, current_mean = 0.0;
+			double baseline_med = 0.0, current_med = 0.0;
+			double baseline_p99 = 0.0, current_p99 = 0.0;
+			uint_fast64_t baseline_time_active_exclusive = 0, current_time_active_exclusive = 0;
+
+			callsite_status status = callsite_status::both;
+			double p_value = 1.0; //two-sided Mann-Whitney U, stays 1.0 for added and removed callsites
+			double impact = 0.0; //estimated change of exclusive time in ns at the current call count, positive is slower
+		};
+
+		class ctrack_comparison {
+		public:
+			template<typename StreamType>
+			void get_comparison_table(StreamType& stream, bool use_color = false) const {
+				static const std::string slower_color = "\033[38;5;160m";
+				static const std::string faster_color = "\033[38;5;34m";
+
+				BeautifulTable table({ "filename", "function", "line","calls base","calls cur","mean","med","p99","time ae","impact","p" }, use_color, default_colors,
+					{ {"callsite",5},{"change current vs baseline",6} });
+				for (const auto& entry : entries) {
+					std::string color{};
+					if (entry.status == callsite_status::both && entry.p_value < significance_level) {
+						color = entry.impact > 0 ? slower_color : faster_color;
+					}
+					std::ostringstream p;
+					if (entry.status == callsite_status::added)
+						p << "added";
+					else if (entry.status == callsite_status::removed)
+						p << "removed";
+					else
+						p << std::setprecision(3) << entry.p_value;
+					auto change = [&](double current, double baseline) { return entry.status == callsite_status::both ? BeautifulTable::table_change(current, baseline) : std::string("-"); };
+					table.addRow({ BeautifulTable::stable_shortenPath(entry.filename), entry.function_name, BeautifulTable::table_string(entry.line),
+						BeautifulTable::table_string(entry.baseline_cnt), BeautifulTable::table_string(entry.current_cnt),
+						change(entry.current_mean, entry.baseline_mean),
+						change(entry.current_med, entry.baseline_med),
+						change(entry.current_p99, entry.baseline_p99),
+						change(static_cast<double>(entry.current_time_active_exclusive), static_cast<double>(entry.baseline_time_active_exclusive)),
+						BeautifulTable::table_signed_time(entry.impact), p.str() }, color);
+				}
+				table.print(stream);
+			}
+
+			double significance_level = 0.05;
+			std::vector<callsite_comparison> entries = {}; //sorted by absolute impact, largest first
+		};
+
+		inline ctrack_comparison compare(const ctrack_snapshot& baseline, const ctrack_snapshot& current, double significance_level = 0.05) {
+			ctrack_comparison res{};
+			res.significance_level = significance_level;
+
+			std::map<std::tuple<std::string_view, std::string_view, int>, std::pair<const snapshot_entry*, const snapshot_entry*>> callsites;
+			for (const auto& entry : baseline.entries)
+				callsites[{ entry.filename, entry.function_name, entry.line }].first = &entry;
+			for (const auto& entry : current.entries)
+				callsites[{ entry.filename, entry.function_name, entry.line }].second = &entry;
+
+			static const snapshot_entry empty_entry{};
+			for (const auto& [key, pair] : callsites) {
+				const snapshot_entry& base = pair.first ? *pair.first : empty_entry;
+				const snapshot_entry& cur = pair.second ? *pair.second : empty_entry;
+
+				callsite_comparison c{};
+				c.filename = std::get<0>(key);
+				c.function_name = std::get<1>(key);
+				c.line = std::get<2>(key);
+				c.baseline_cnt = static_cast<unsigned int>(base.durations.size());
+				c.current_cnt = static_cast<unsigned int>(cur.durations.size());
+				if (c.baseline_cnt > 0)
+					c.baseline_mean = std::accumulate(base.durations.begin(), base.durations.end(), 0.0) / c.baseline_cnt;
+				if (c.current_cnt > 0)
+					c.current_mean = std::accumulate(cur.durations.begin(), cur.durations.end(), 0.0) / c.current_cnt;
+				c.baseline_med = sorted_quantile(base.durations, 0.5);
+				c.current_med = sorted_quantile(cur.durations, 0.5);
+				c.baseline_p99 = sorted_quantile(base.durations, 0.99);
+				c.current_p99 = sorted_quantile(cur.durations, 0.99);
+				c.baseline_time_active_exclusive = base.time_active_exclusive;
+				c.current_time_active_exclusive = cur.time_active_exclusive;
+				if (c.baseline_cnt == 0 || c.current_cnt == 0) {
+					c.status = c.baseline_cnt == 0 ? callsite_status::added : callsite_status::removed;
+					c.impact = static_cast<double>(cur.time_active_exclusive) - static_cast<double>(base.time_active_exclusive);
+				}
+				else {
+					c.p_value = mann_whitney_p_value(base.durations, cur.durations);
+					const double base_ae_per_call = static_cast<double>(base.time_active_exclusive) / c.baseline_cnt;
+					const double cur_ae_per_call = static_cast<double>(cur.time_active_exclusive) / c.current_cnt;
+					c.impact = (cur_ae_per_call - base_ae_per_call) * c.current_cnt;
+				}
+				res.entries.push_back(std::move(c));
+			}
+
+			std::sort(res.entries.begin(), res.entries.end(), [](const callsite_comparison& a, const callsite_comparison& b) {
+				return std::abs(a.impact) > std::abs(b.impact);
+				});
+			return res;
+		}
+
+		inline ctrack_comparison compare(const ctrack_result& baseline, const ctrack_result& current, double significance_level = 0.05) {
+			return compare(make_snapshot(baseline), make_snapshot(current), significance_level);
+		}
+
+		inline ctrack_comparison compare(const ctrack_snapshot& baseline, const ctrack_result& current, double significance_level = 0.05) {
+			return compare(baseline, make_snapshot(current), significance_level);
+		}
+
+		inline ctrack_comparison compare(const ctrack_result& baseline, const ctrack_snapshot& current, double significance_level = 0.05) {
+			return compare(make_snapshot(baseline), current, significance_level);
+		}
+
+		inline int fetch_event_t_id() {
+			if (thread_id == nullptr || *thread_id == -1) {
+				std::scoped_lock lock(store::event_mutex);
+
+				if (thread_id == nullptr) {
+					store::a_thread_ids.emplace_back(++store::thread_cnt);
+					thread_id = &store::a_thread_ids[store::a_thread_ids.size() - 1];
+				}
+				else {
+					*thread_id = ++store::thread_cnt;
+				}
+
+				store::a_events.emplace_back(t_events{});
+				store::a_sub_events.emplace_back(sub_events{});
+				store::a_span_links.emplace_back(span_links{});
+				store::a_coroutine_records.emplace_back(coroutine_records{});
+				store::a_queue_events.emplace_back(queue_events{});
+				store::a_metric_records.emplace_back(metric_records{});
+				store::a_span_args.emplace_back(span_args{});
+				store::a_batch_counts.emplace_back(batch_counts{});
+				store::a_lock_events.emplace_back(lock_events{});
+				store::a_current_event_id.emplace_back(0);
+				store::a_current_event_cnt.emplace_back(0);
+				store::a_string_id.emplace_back(0);
+
+				event_ptr = &store::a_events[*thread_id];
+				sub_events_ptr = &store::a_sub_events[*thread_id];
+				span_links_ptr = &store::a_span_links[*thread_id];
+				coroutine_records_ptr = &store::a_coroutine_records[*thread_id];
+				queue_events_ptr = &store::a_queue_events[*thread_id];
+				metric_records_ptr = &store::a_metric_records[*thread_id];
+				span_args_ptr = &store::a_span_args[*thread_id];
+				batch_counts_ptr = &store::a_batch_counts[*thread_id];
+				lock_events_ptr = &store::a_lock_events[*thread_id];
+
+				current_event_id = &store::a_current_event_id[*thread_id];
+				current_event_cnt = &store::a_current_event_cnt[*thread_id];
+				string_id = &store::a_string_id[*thread_id];
+
+				event_ptr->reserve(100);
+			}
+			return *thread_id;
+		}
+
+#ifdef CTRACK_ENABLE_CAUSAL
+		//causal profiling: while an experiment runs, every call of the selected callsite that takes d ns makes all other
+		//threads pause d * speedup ns. The pauses are paid at span ends and progress points, the effect of the virtual
+		//speedup is measured on the progress points with the inserted pauses subtracted from the elapsed time
+		//the pauses land inside the enclosing spans of the pausing thread, spans recorded while experiments run are not
+		//representative of the program's normal timings
+		struct progress_point_counter {
+			std::string name;
+			std::atomic<uint_fast64_t> cnt{ 0 };
+			explicit progress_point_counter(const std::string& name) : name(name) {}
+		};
+
+		struct causal_store {
+			inline static std::mutex progress_mutex;
+			inline static std::deque<progress_point_counter> progress_points{};
+
+			inline static std::atomic<int> selected_line{ -1 };
+			inline static std::atomic<const std::string*> selected_filename{ nullptr };
+			inline static std::atomic<const std::string*> selected_function{ nullptr };
+			inline static std::atomic<double> speedup{ 0.0 }; //between 0-1
+			inline static std::atomic<uint_fast64_t> global_delay{ 0 };
+		};
+
+		inline thread_local bool causal_thread_registered = false;
+		inline thread_local uint_fast64_t causal_local_delay = 0;
+
+		inline std::atomic<uint_fast64_t>& progress_counter(const std::string& name) {
+			std::scoped_lock lock(causal_store::progress_mutex);
+			for (auto& entry : causal_store::progress_points) {
+				if (entry.name == name)
+					return entry.cnt;
+			}
+			return causal_store::progress_points.emplace_back(name).cnt;
+		}
+
+		inline void causal_pause(uint_fast64_t nanoseconds) {
+			const auto end = std::chrono::high_resolution_clock::now() + std::chrono::nanoseconds(nanoseconds);
+			if (nanoseconds > 200000)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds - 100000));
+			while (std::chrono::high_resolution_clock::now() < end) {}
+		}
+
+		//pays the pauses other threads requested since the last sync
+		inline void causal_sync() {
+			const uint_fast64_t global = causal_store::global_delay.load(std::memory_order_relaxed);
+			if (!causal_thread_registered) {
+				causal_thread_registered = true;
+				causal_local_delay = global;
+				return;
+			}
+			if (global > causal_local_delay) {
+				causal_pause(global - causal_local_delay);
+				causal_local_delay = global;
+			}
+		}
+
+		inline void causal_span_end(const std::string_view filename, const std::string_view function, const int line, uint_fast64_t duration) {
+			causal_sync();
+			if (line != causal_store::selected_line.load(std::memory_order_relaxed))
+				return;
+			const std::string* selected_function = causal_store::selected_function.load(std::memory_order_acquire);
+			const std::string* selected_filename = causal_store::selected_filename.load(std::memory_order_acquire);
+			if (selected_function == nullptr || selected_filename == nullptr || function != *selected_function || filename != *selected_filename)
+				return;
+			const auto delay = static_cast<uint_fast64_t>(static_cast<double>(duration) * causal_store::speedup.load(std::memory_order_relaxed));
+			causal_store::global_delay.fetch_add(delay, std::memory_order_relaxed);
+			causal_local_delay += delay;
+		}
+
+		//threads that were blocked (e.g. joining workers) skip the pauses inserted while they waited, as they were woken by threads that already paid
+		class causal_blocked_scope {
+		public:
+			causal_blocked_scope() = default;
+			~causal_blocked_scope() {
+				causal_thread_registered = true;
+				causal_local_delay = causal_store::global_delay.load(std::memory_order_relaxed);
+			}
+			causal_blocked_scope(const causal_blocked_scope&) = delete;
+			causal_blocked_scope& operator=(const causal_blocked_scope&) = delete;
+		};
+#endif
+
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+		//counted by the operator new replacements of CTRACK_ALLOC_HOOK_IMPLEMENTATION. Constant initialized, so the
+		//counters can be used from operator new before anything else of the thread is set up
+		struct alloc_counters {
+			uint64_t allocations = 0;
+			uint64_t bytes = 0;
+			bool paused = false; //set while ctrack does its own bookkeeping
+		};
+		inline thread_local alloc_counters thread_alloc_counters{};
+
+		inline void count_allocation(std::size_t size) noexcept {
+			alloc_counters& counters = thread_alloc_counters;
+			if (counters.paused)
+				return;
+			counters.allocations++;
+			counters.bytes += size;
+		}
+
+		//keeps the allocations of ctrack's own bookkeeping (growing the per thread buffers) out of the counters, nests
+		class alloc_pause {
+		public:
+			alloc_pause() : previous(thread_alloc_counters.paused) { thread_alloc_counters.paused = true; }
+			~alloc_pause() { thread_alloc_counters.paused = previous; }
+			alloc_pause(const alloc_pause&) = delete;
+			alloc_pause& operator=(const alloc_pause&) = delete;
+		private:
+			bool previous;
+		};
+#else
+		class alloc_pause {
+		public:
+			alloc_pause() {}
+			~alloc_pause() {}
+			alloc_pause(const alloc_pause&) = delete;
+			alloc_pause& operator=(const alloc_pause&) = delete;
+		};
+#endif
+
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+		//cpu the calling thread runs on. sched_getcpu is served from the vdso or rseq on linux, no syscall
+		inline uint16_t current_cpu() {
+#if defined(__linux__)
+			const int cpu = sched_getcpu();
+			return cpu >= 0 && cpu < unknown_cpu ? static_cast<uint16_t>(cpu) : unknown_cpu;
+#elif defined(_WIN32)
+			//GetCurrentProcessorNumber only numbers the cpus of the thread's processor group, groups can hold fewer than 64 cpus
+			//so cpus are numbered after the active cpus of all lower groups
+			static const std::vector<unsigned int> group_offsets = [] {
+				std::vector<unsigned int> offsets(GetActiveProcessorGroupCount(), 0u);
+				for (size_t group = 1; group < offsets.size(); group++)
+					offsets[group] = offsets[group - 1] + GetActiveProcessorCount(static_cast<WORD>(group - 1));
+				return offsets;
+			}();
+			PROCESSOR_NUMBER number{};
+			GetCurrentProcessorNumberEx(&number);
+			if (number.Group >= group_offsets.size())
+				return unknown_cpu;
+			const unsigned int cpu = group_offsets[number.Group] + number.Number;
+			return cpu < unknown_cpu ? static_cast<uint16_t>(cpu) : unknown_cpu;
+#else
+			return unknown_cpu;
+#endif
+		}
+#endif
+
+#ifdef CTRACK_HAS_RUSAGE
+		struct thread_rusage {
+			long minor_faults = 0;
+			long major_faults = 0;
+			long voluntary_switches = 0;
+			long involuntary_switches = 0;
+			bool valid = false; //false if getrusage failed, a span with an invalid sample reports no rusage
+		};
+
+		inline thread_rusage sample_thread_rusage() {
+			struct rusage usage {};
+			if (getrusage(RUSAGE_THREAD, &usage) != 0)
+				return {};
+			return { usage.ru_minflt, usage.ru_majflt, usage.ru_nvcsw, usage.ru_nivcsw, true };
+		}
+#endif
+
+#ifdef CTRACK_ENABLE_CPU_TIME
+		//cpu time of the calling thread in ns. GetThreadTimes only advances with the scheduler tick (about 15.6 ms by default),
+		//so on Windows only spans well above the tick give a meaningful cpu time. Returns false if the clock could not be read
+		inline bool thread_cpu_time(uint64_t& time) {
+#ifdef _WIN32
+			FILETIME creation, exit, kernel, user;
+			if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+				return false;
+			const uint64_t kernel_time = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+			const uint64_t user_time = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+			time = (kernel_time + user_time) * 100;
+#else
+			timespec ts{};
+			if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+				return false;
+			time = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+			return true;
+		}
+#endif
+
+#ifdef CTRACK_HAS_PERF_COUNTERS
+		//per thread hardware counters, opened on first use. Values are read with rdpmc from the mmapped counter pages when
+		//the kernel allows it, otherwise with one read() of the whole group. Without perf access no counter is valid.
+		//The enabled and running times of the group are read with the values, so spans can be scaled for multiplexing
+		class perf_counters {
+		public:
+			static constexpr int counter_cnt = 4;
+
+			struct sample {
+				uint64_t values[counter_cnt] = {};
+				uint64_t time_enabled = 0; //ns the group was enabled, and of that on the pmu
+				uint64_t time_running = 0;
+			};
+
+			perf_counters() = default;
+			perf_counters(const perf_counters&) = delete;
+			perf_counters& operator=(const perf_counters&) = delete;
+			~perf_counters() {
+				for (int i = 0; i < counter_cnt; i++) {
+					if (pages[i] != nullptr)
+						munmap(pages[i], page_size);
+					if (fds[i] >= 0)
+						close(fds[i]);
+				}
+			}
+
+			//returns the mask of the counters that were read
+			uint8_t read(sample& s) {
+				if (!opened)
+					open();
+				if (mask == 0)
+					return 0;
+				bool need_syscall = !read_rdpmc_times(s.time_enabled, s.time_running);
+				for (int i = 0; i < counter_cnt; i++) {
+					if ((mask >> i) & 1)
+						need_syscall |= !read_rdpmc(i, s.values[i]);
+				}
+				if (need_syscall)
+					read_group(s);
+				return mask;
+			}
+
+			//counter deltas of a span, scaled up by enabled / running when the kernel multiplexed the group. Returns the
+			//mask of valid counters, none if the group never ran during the span
+			static uint8_t span_delta(const sample& start, const sample& end, uint8_t span_mask, uint64_t deltas[counter_cnt]) {
+				const uint64_t enabled = end.time_enabled - start.time_enabled;
+				const uint64_t running = end.time_running - start.time_running;
+				if (enabled > 0 && running == 0)
+					return 0;
+				const double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+				for (int i = 0; i < counter_cnt; i++) {
+					const uint64_t delta = end.values[i] - start.values[i];
+					deltas[i] = scale == 1.0 ? delta : static_cast<uint64_t>(static_cast<double>(delta) * scale);
+				}
+				return span_mask;
+			}
+		private:
+			void open() {
+				opened = true;
+				page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+				const uint64_t configs[counter_cnt] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+				for (int i = 0; i < counter_cnt; i++) {
+					perf_event_attr attr{};
+					attr.size = sizeof(perf_event_attr);
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = configs[i];
+					attr.disabled = i == 0 ? 1 : 0;
+					attr.exclude_kernel = 1;
+					attr.exclude_hv = 1;
+					attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+					const int group_fd = i == 0 ? -1 : fds[0];
+					if (i > 0 && group_fd < 0)
+						return;
+					fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+					if (fds[i] < 0)
+						continue;
+					mask |= static_cast<uint8_t>(1u << i);
+					group_order[group_size++] = i;
+					void* page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fds[i], 0);
+					pages[i] = page == MAP_FAILED ? nullptr : static_cast<perf_event_mmap_page*>(page);
+				}
+				if (fds[0] >= 0) {
+					ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+					ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+				}
+			}
+
+			bool read_rdpmc(int i, uint64_t& value) const {
+#if defined(__x86_64__) || defined(__i386__)
+				const perf_event_mmap_page* page = pages[i];
+				if (page == nullptr)
+					return false;
+				uint32_t seq;
+				uint64_t count;
+				do {
+					seq = page->lock;
+					std::atomic_signal_fence(std::memory_order_acq_rel);
+					const uint32_t index = page->index;
+					if (!page->cap_user_rdpmc || index == 0)
+						return false;
+					count = static_cast<uint64_t>(page->offset);
+					uint64_t pmc = static_cast<uint64_t>(__builtin_ia32_rdpmc(static_cast<int>(index - 1)));
+					const uint16_t width = page->pmc_width;
+					pmc <<= 64 - width;
+					pmc = static_cast<uint64_t>(static_cast<int64_t>(pmc) >> (64 - width));
+					count += pmc;
+					std::atomic_signal_fence(std::memory_order_acq_rel);
+				} while (page->lock != seq);
+				value = count;
+				return true;
+#else
+				(void)i;
+				(void)value;
+				return false;
+#endif
+			}
+
+			//enabled and running time of the group from the leader's page, extended to now with the tsc like the
+			//kernel's perf_event_mmap_page documentation describes
+			bool read_rdpmc_times(uint64_t& enabled, uint64_t& running) const {
+#if defined(__x86_64__) || defined(__i386__)
+				const perf_event_mmap_page* page = pages[0];
+				if (page == nullptr)
+					return false;
+				uint32_t seq;
+				do {
+					seq = page->lock;
+					std::atomic_signal_fence(std::memory_order_acq_rel);
+					if (!page->cap_user_time)
+						return false;
+					enabled = page->time_enabled;
+					running = page->time_running;
+					const uint64_t cycles = __builtin_ia32_rdtsc();
+					const uint16_t shift = page->time_shift;
+					const uint64_t mult = page->time_mult;
+					const uint64_t quot = cycles >> shift;
+					const uint64_t rem = cycles & ((uint64_t(1) << shift) - 1);
+					const uint64_t delta = page->time_offset + quot * mult + ((rem * mult) >> shift);
+					enabled += delta;
+					if (page->index != 0)
+						running += delta;
+					std::atomic_signal_fence(std::memory_order_acq_rel);
+				} while (page->lock != seq);
+				return true;
+#else
+				(void)enabled;
+				(void)running;
+				return false;
+#endif
+			}
+
+			void read_group(sample& s) const {
+				//nr, time enabled, time running, values
+				uint64_t buffer[3 + counter_cnt] = {};
+				if (::read(fds[0], buffer, sizeof(buffer)) <= 0)
+					return;
+				s.time_enabled = buffer[1];
+				s.time_running = buffer[2];
+				for (uint64_t j = 0; j < buffer[0] && j < static_cast<uint64_t>(group_size); j++)
+					s.values[group_order[j]] = buffer[3 + j];
+			}
+
+			int fds[counter_cnt] = { -1, -1, -1, -1 };
+			perf_event_mmap_page* pages[counter_cnt] = {};
+			int group_order[counter_cnt] = {};
+			int group_size = 0;
+			size_t page_size = 0;
+			uint8_t mask = 0;
+			bool opened = false;
+		};
+
+		inline thread_local perf_counters thread_perf_counters{};
+#endif
+
+		class EventHandler {
+		public:
+			EventHandler(int line = __builtin_LINE(), const char* filename = __builtin_FILE(), const char* function = __builtin_FUNCTION(), std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now(), event_kind kind = event_kind::span) : line(line), kind(kind)
+
+			{
+				this->start_time = start_time;
+				previous_store_clear_cnt = store::store_clear_cnt;
+				this->filename = filename;
+				this->function = function;
+				{
+					const alloc_pause pause{};
+					while (store::write_events_locked) {}
+
+					register_event();
+#ifdef CTRACK_HAS_PERF_COUNTERS
+					counter_mask = thread_perf_counters.read(start_counters);
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+					start_cpu_time_valid = thread_cpu_time(start_cpu_time);
+					start_cpu_wall = std::chrono::high_resolution_clock::now();
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+					start_rusage = sample_thread_rusage();
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+					start_cpu = current_cpu();
+#endif
+				}
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+				start_allocations = thread_alloc_counters.allocations;
+				start_allocated_bytes = thread_alloc_counters.bytes;
+#endif
+			}
+			~EventHandler() {
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				const uint16_t end_cpu = current_cpu();
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+				const uint64_t allocations = thread_alloc_counters.allocations - start_allocations;
+				const uint64_t allocated_bytes = thread_alloc_counters.bytes - start_allocated_bytes;
+#endif
+				const alloc_pause pause{};
+#ifdef CTRACK_ENABLE_CPU_TIME
+				//the wall window sits right inside the cpu time window, the span's own wall time also covers the cpu clock reads
+				const auto end_cpu_wall = std::chrono::high_resolution_clock::now();
+				uint64_t end_cpu_time = 0;
+				const bool end_cpu_time_valid = start_cpu_time_valid && thread_cpu_time(end_cpu_time);
+#endif
+#ifdef CTRACK_HAS_PERF_COUNTERS
+				perf_counters::sample end_counters{};
+				const uint8_t end_counter_mask = counter_mask != 0 ? thread_perf_counters.read(end_counters) : 0;
+#endif
+				auto end_time = std::chrono::high_resolution_clock::now();
+#ifdef CTRACK_HAS_RUSAGE
+				//sampled after end_time, so the getrusage call is not part of the span's wall time
+				const bool sample_rusage = start_rusage.valid && end_time - start_time >= std::chrono::nanoseconds(CTRACK_RUSAGE_MIN_DURATION_NS);
+				const thread_rusage end_rusage = sample_rusage ? sample_thread_rusage() : thread_rusage{};
+#endif
+				while (store::write_events_locked) {}
+
+				if (store::store_clear_cnt != previous_store_clear_cnt)
+				{
+					register_event();
+				}
+
+
+				if (event_ptr->capacity() - event_ptr->size() < 1) event_ptr->reserve(event_ptr->capacity() * 4);
+
+				event_ptr->emplace_back(Event{ start_time,end_time,filename,line,function,t_id ,event_id, kind });
+#ifdef CTRACK_HAS_PERF_COUNTERS
+				event_ptr->back().counter_mask = perf_counters::span_delta(start_counters, end_counters, counter_mask & end_counter_mask, event_ptr->back().counters);
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+				//a failed sample would show up as 100% off cpu, the span is reported without cpu time instead
+				if (end_cpu_time_valid) {
+					event_ptr->back().has_cpu_time = true;
+					event_ptr->back().cpu_time = end_cpu_time > start_cpu_time ? end_cpu_time - start_cpu_time : 0;
+					event_ptr->back().cpu_wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end_cpu_wall - start_cpu_wall).count();
+				}
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+				event_ptr->back().start_cpu = start_cpu;
+				event_ptr->back().end_cpu = end_cpu;
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+				if (end_rusage.valid) {
+					event_ptr->back().has_rusage = true;
+					event_ptr->back().minor_faults = static_cast<uint32_t>(end_rusage.minor_faults - start_rusage.minor_faults);
+					event_ptr->back().major_faults = static_cast<uint32_t>(end_rusage.major_faults - start_rusage.major_faults);
+					event_ptr->back().voluntary_switches = static_cast<uint32_t>(end_rusage.voluntary_switches - start_rusage.voluntary_switches);
+					event_ptr->back().involuntary_switches = static_cast<uint32_t>(end_rusage.involuntary_switches - start_rusage.involuntary_switches);
+				}
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+				event_ptr->back().has_allocations = true;
+				event_ptr->back().allocations = allocations;
+				event_ptr->back().allocated_bytes = allocated_bytes;
+#endif
+
+				*current_event_id = previous_event_id;
+				if (previous_event_id == 0 && linked_parent.parent_id != 0 && linked_parent.store_clear_cnt == store::store_clear_cnt) {
+					span_links_ptr->push_back(span_link{ linked_parent.parent_id, get_unique_event_id(t_id, event_id) });
+				}
+				if (previous_event_id > 0) {
+					if ((*sub_events_ptr)[previous_event_id].capacity() - (*sub_events_ptr)[previous_event_id].size() < 1) (*sub_events_ptr)[previous_event_id].reserve((*sub_events_ptr)[previous_event_id].capacity() * 4);
+					(*sub_events_ptr)[previous_event_id].push_back(event_id);
+				}
+#ifdef CTRACK_ENABLE_CAUSAL
+				causal_span_end(filename, function, line, std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+#endif
+			}
+		private:
+			void register_event() {
+				t_id = fetch_event_t_id();
+				previous_event_id = *current_event_id;
+				event_id = ++(*current_event_cnt);
+				*current_event_id = event_id;
+			}
+			std::chrono::high_resolution_clock::time_point start_time;
+			int line;
+			unsigned int previous_store_clear_cnt;
+
+			std::string_view filename, function;
+			event_kind kind;
+#ifdef CTRACK_HAS_PERF_COUNTERS
+			uint8_t counter_mask = 0;
+			perf_counters::sample start_counters{};
+#endif
+#ifdef CTRACK_ENABLE_CPU_TIME
+			uint64_t start_cpu_time = 0;
+			bool start_cpu_time_valid = false;
+			std::chrono::high_resolution_clock::time_point start_cpu_wall{};
+#endif
+#ifdef CTRACK_HAS_RUSAGE
+			thread_rusage start_rusage = {};
+#endif
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			uint16_t start_cpu = unknown_cpu;
+#endif
+#ifdef CTRACK_ENABLE_ALLOC_TRACKING
+			uint64_t start_allocations = 0;
+			uint64_t start_allocated_bytes = 0;
+#endif
+
+			int t_id;
+			unsigned int event_id;
+			unsigned int previous_event_id;
+		};
+
+		//marks the current span as the parent of work handed to other threads
+		inline fork_point mark_fork() {
+#ifndef CTRACK_DISABLE
+			const alloc_pause pause{};
+			auto t_id = fetch_event_t_id();
+			if (*current_event_id == 0)
+				return linked_parent;
+			return fork_point{ get_unique_event_id(t_id, *current_event_id), store::store_clear_cnt };
+#else
+			return {};
+#endif
+		}
+
+		//top level spans of this thread started while the scope is alive become children of the fork point
+		class forked_scope {
+		public:
+			explicit forked_scope(const fork_point& fp) : previous(linked_parent) {
+#ifndef CTRACK_DISABLE
+				linked_parent = fp;
+#else
+				(void)fp;
+#endif
+			}
+			~forked_scope() {
+#ifndef CTRACK_DISABLE
+				linked_parent = previous;
+#endif
+			}
+			forked_scope(const forked_scope&) = delete;
+			forked_scope& operator=(const forked_scope&) = delete;
+		private:
+			fork_point previous;
+		};
+
+		//logical parent captured at task submission and adopted by the task on the worker thread
+		using context = fork_point;
+
+		inline context current() {
+			return mark_fork();
+		}
+
+		//spans started on this thread at top level while the returned scope is alive become children of ctx
+		[[nodiscard]] inline forked_scope adopt(const context& ctx) {
+			return forked_scope{ ctx };
+		}
+
+		//coordinating span of CTRACK_PARALLEL_REGION, doubles as the fork point its workers enter with CTRACK_FORKED
+		class parallel_region_scope : public EventHandler {
+		public:
+			parallel_region_scope(int line, const char* filename, const char* function, std::chrono::high_resolution_clock::time_point start_time)
+				: EventHandler(line, filename, function, start_time, event_kind::parallel_region), fork(mark_fork()) {}
+			operator const fork_point& () const { return fork; }
+		private:
+			fork_point fork;
+		};
+
+		//span begun with ctrack::begin and recorded by ctrack::end, may be moved to and ended on another thread
+		class span_token {
+		public:
+			span_token() = default;
+			span_token(span_token&& other) noexcept { *this = std::move(other); }
+			span_token& operator=(span_token&& other) noexcept {
+				start_time = other.start_time;
+				filename = other.filename;
+				function = other.function;
+				line = other.line;
+				parent = other.parent;
+				store_clear_cnt = other.store_clear_cnt;
+				active = std::exchange(other.active, false);
+				return *this;
+			}
+			span_token(const span_token&) = delete;
+			span_token& operator=(const span_token&) = delete;
+
+			bool is_active() const { return active; }
+		private:
+			friend span_token begin(const char* name, int line, const char* filename);
+			friend void end(span_token& token);
+
+			std::chrono::high_resolution_clock::time_point start_time{};
+			std::string_view filename{}, function{};
+			int line = 0;
+			fork_point parent{};
+			unsigned int store_clear_cnt = 0;
+			bool active = false;
+		};
+
+		//the span the calling thread is in when begin is called becomes the parent of the manual span
+		inline span_token begin(const char* name, int line = __builtin_LINE(), const char* filename = __builtin_FILE()) {
+			span_token token{};
+#ifndef CTRACK_DISABLE
+			token.parent = mark_fork();
+			token.filename = filename;
+			token.function = name;
+			token.line = line;
+			token.store_clear_cnt = store::store_clear_cnt;
+			token.active = true;
+			token.start_time = std::chrono::high_resolution_clock::now();
+#else
+			(void)name; (void)line; (void)filename;
+#endif
+			return token;
+		}
+
+		template<typename T>
+		uint_fast64_t queue_item_id(const T& id) {
+			if constexpr (std::is_pointer_v<T>)
+				return static_cast<uint_fast64_t>(reinterpret_cast<std::uintptr_t>(id));
+			else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+				return static_cast<uint_fast64_t>(id);
+			else
+				return static_cast<uint_fast64_t>(std::hash<T>{}(id));
+		}
+
+		inline void queue_mark(const char* queue, uint_fast64_t item_id, bool dequeue) {
+			auto time = std::chrono::high_resolution_clock::now();
+			const alloc_pause pause{};
+			while (store::write_events_locked) {}
+			fetch_event_t_id();
+			if (queue_events_ptr->capacity() - queue_events_ptr->size() < 1) queue_events_ptr->reserve(std::max<size_t>(100, queue_events_ptr->capacity() * 4));
+			queue_events_ptr->push_back(queue_event{ time, queue, item_id, dequeue });
+		}
+
+		//counters are attached to the innermost span of the calling thread, or to the adopted parent outside of spans
+		inline void metric_mark(const char* name, double value, bool gauge) {
+			auto time = std::chrono::high_resolution_clock::now();
+			const alloc_pause pause{};
+			while (store::write_events_locked) {}
+			const unsigned int store_clear_cnt = store::store_clear_cnt;
+			const int t_id = fetch_event_t_id();
+			uint_fast64_t span_id = 0;
+			if (*current_event_id != 0)
+				span_id = get_unique_event_id(t_id, *current_event_id);
+			else if (linked_parent.store_clear_cnt == store_clear_cnt)
+				span_id = linked_parent.parent_id;
+			//ids of an earlier store resolve to unrelated events
+			if (store_clear_cnt != store::store_clear_cnt)
+				span_id = 0;
+			if (metric_records_ptr->capacity() - metric_records_ptr->size() < 1) metric_records_ptr->reserve(std::max<size_t>(100, metric_records_ptr->capacity() * 4));
+			metric_records_ptr->push_back(metric_record{ time, name, value, span_id, gauge });
+		}
+
+		//caller of CTRACK_LOCK / CTRACK_LOCK_SHARED, empty for a plain lock() e.g. from std::lock_guard
+		struct lock_site {
+			std::string_view filename{}, function{};
+			int line = 0;
+		};
+
+#ifndef CTRACK_DISABLE
+		//locks held by this thread, the acquisition is completed into a lock_event on release
+		struct pending_lock {
+			const void* mutex;
+			std::chrono::high_resolution_clock::time_point acquired;
+			uint_fast64_t wait;
+			uint_fast64_t holder_id;
+			unsigned int store_clear_cnt;
+			lock_site site;
+			bool contended;
+			bool shared;
+		};
+		inline thread_local std::vector<pending_lock> pending_locks{};
+
+		class lock_tracking {
+		protected:
+			lock_tracking(const char* name, int line, const char* filename) : name(name == nullptr ? "" : name), filename(filename), line(line) {}
+
+			void acquired(std::chrono::high_resolution_clock::time_point wait_start, bool contended, bool shared, const lock_site& site) {
+				auto time = std::chrono::high_resolution_clock::now();
+				const alloc_pause pause{};
+				while (store::write_events_locked) {}
+				const int t_id = fetch_event_t_id();
+				const unsigned int holder_event_id = *current_event_id;
+				const uint_fast64_t holder_id = holder_event_id != 0 ? get_unique_event_id(t_id, holder_event_id) : 0;
+				const uint_fast64_t wait = contended ? std::chrono::duration_cast<std::chrono::nanoseconds>(time - wait_start).count() : 0;
+				if (contended)
+					record_wait(wait_start, time, site, holder_event_id);
+				pending_locks.push_back(pending_lock{ this, time, wait, holder_id, store::store_clear_cnt, site, contended, shared });
+			}
+
+			void released(bool shared) {
+				auto time = std::chrono::high_resolution_clock::now();
+				const alloc_pause pause{};
+				auto it = std::find_if(pending_locks.rbegin(), pending_locks.rend(), [&](const pending_lock& p) { return p.mutex == this && p.shared == shared; });
+				if (it == pending_locks.rend())
+					return;
+				pending_lock pending = *it;
+				pending_locks.erase(std::next(it).base());
+				while (store::write_events_locked) {}
+				fetch_event_t_id();
+				//ids of an earlier store resolve to unrelated events
+				if (pending.store_clear_cnt != store::store_clear_cnt)
+					pending.holder_id = 0;
+				if (lock_events_ptr->capacity() - lock_events_ptr->size() < 1) lock_events_ptr->reserve(std::max<size_t>(100, lock_events_ptr->capacity() * 4));
+				lock_events_ptr->push_back(lock_event{ pending.acquired, time, pending.wait, pending.holder_id, name, filename, line,
+					pending.site.filename, pending.site.function, pending.site.line, pending.contended, shared });
+			}
+
+			std::string_view name, filename;
+			int line;
+		private:
+			//wait span of a contended acquisition, a child of the innermost span like CTRACK_WAIT. It is placed at the
+			//CTRACK_LOCK site, or at the construction site of the mutex for a plain lock(). Hold times only go to the lock statistics
+			void record_wait(std::chrono::high_resolution_clock::time_point start_time, std::chrono::high_resolution_clock::time_point end_time,
+				const lock_site& site, unsigned int parent_event_id) {
+				const int t_id = fetch_event_t_id();
+				const unsigned int event_id = ++(*current_event_cnt);
+				if (event_ptr->capacity() - event_ptr->size() < 1) event_ptr->reserve(event_ptr->capacity() * 4);
+				const bool has_site = !site.function.empty();
+				event_ptr->emplace_back(Event{ start_time,end_time,has_site ? site.filename : filename,has_site ? site.line : line,"lock wait",t_id ,event_id, event_kind::wait });
+				if (parent_event_id > 0) {
+					if ((*sub_events_ptr)[parent_event_id].capacity() - (*sub_events_ptr)[parent_event_id].size() < 1) (*sub_events_ptr)[parent_event_id].reserve((*sub_events_ptr)[parent_event_id].capacity() * 4);
+					(*sub_events_ptr)[parent_event_id].push_back(event_id);
+				}
+				else if (linked_parent.parent_id != 0 && linked_parent.store_clear_cnt == store::store_clear_cnt) {
+					span_links_ptr->push_back(span_link{ linked_parent.parent_id, get_unique_event_id(t_id, event_id) });
+				}
+			}
+		};
+
+		//std::mutex replacement recording wait and hold times, an uncontended lock costs a try_lock and one timestamp
+		class tracked_mutex : private lock_tracking {
+		public:
+			explicit tracked_mutex(const char* name = nullptr, int line = __builtin_LINE(), const char* filename = __builtin_FILE()) : lock_tracking(name, line, filename) {}
+			tracked_mutex(const tracked_mutex&) = delete;
+			tracked_mutex& operator=(const tracked_mutex&) = delete;
+
+			void lock() {
+				lock(lock_site{});
+			}
+			void lock(const lock_site& site) {
+				if (mutex.try_lock()) {
+					acquired({}, false, false, site);
+					return;
+				}
+				auto wait_start = std::chrono::high_resolution_clock::now();
+				mutex.lock();
+				acquired(wait_start, true, false, site);
+			}
+			bool try_lock() {
+				if (!mutex.try_lock())
+					return false;
+				acquired({}, false, false, lock_site{});
+				return true;
 			}
-
-			inline void add_event(const std::string_view& filename, const std::string_view function, const int line, const Event& e) {
-				f_res[filename][function][line].all_events.push_back(e);
-				a_events.insert({ get_unique_event_id(e.thread_id, e.event_id), e });
+			void unlock() {
+				released(false);
+				mutex.unlock();
 			}
+		private:
+			std::mutex mutex;
+		};
 
-			void add_sub_events(const sub_events& s_events, const unsigned int thread_id_) {
+		class tracked_shared_mutex : private lock_tracking {
+		public:
+			explicit tracked_shared_mutex(const char* name = nullptr, int line = __builtin_LINE(), const char* filename = __builtin_FILE()) : lock_tracking(name, line, filename) {}
+			tracked_shared_mutex(const tracked_shared_mutex&) = delete;
+			tracked_shared_mutex& operator=(const tracked_shared_mutex&) = delete;
 
-				for (auto const& [key, val] : s_events)
-				{
-					int_fast64_t parent_id = get_unique_event_id(thread_id_, key);
-					for (const auto& child : val) {
-						child_graph[parent_id].push_back(get_unique_event_id(thread_id_, child));
-					}
+			void lock() {
+				lock(lock_site{});
+			}
+			void lock(const lock_site& site) {
+				if (mutex.try_lock()) {
+					acquired({}, false, false, site);
+					return;
 				}
+				auto wait_start = std::chrono::high_resolution_clock::now();
+				mutex.lock();
+				acquired(wait_start, true, false, site);
+			}
+			bool try_lock() {
+				if (!mutex.try_lock())
+					return false;
+				acquired({}, false, false, lock_site{});
+				return true;
+			}
+			void unlock() {
+				released(false);
+				mutex.unlock();
 			}
 
-			std::unordered_map < int_fast64_t, Event> a_events{};
-			filename_result f_res{};
-
-			std::unordered_map< int_fast64_t, std::vector< int_fast64_t>> child_graph{};
-			ctrack_result_settings settings;
-			std::chrono::high_resolution_clock::time_point track_start_time, track_end_time;
-			uint_fast64_t time_total;
-			uint_fast64_t sum_time_active_exclusive = 0;
-
-			uint_fast64_t ctracked_files = 0;
-			uint_fast64_t ctracked_functions = 0;
-			uint_fast64_t ctracked_uses = 0;
-
-			std::vector<EventGroup*> sorted_events{};
-			std::string center_intervall_str;
+			void lock_shared() {
+				lock_shared(lock_site{});
+			}
+			void lock_shared(const lock_site& site) {
+				if (mutex.try_lock_shared()) {
+					acquired({}, false, true, site);
+					return;
+				}
+				auto wait_start = std::chrono::high_resolution_clock::now();
+				mutex.lock_shared();
+				acquired(wait_start, true, true, site);
+			}
+			bool try_lock_shared() {
+				if (!mutex.try_lock_shared())
+					return false;
+				acquired({}, false, true, lock_site{});
+				return true;
+			}
+			void unlock_shared() {
+				released(true);
+				mutex.unlock_shared();
+			}
+		private:
+			std::shared_mutex mutex;
+		};
+#else
+		//plain std::mutex / std::shared_mutex pass-throughs, nothing is recorded
+		class tracked_mutex {
+		public:
+			explicit tracked_mutex(const char* = nullptr, int = 0, const char* = nullptr) {}
+			tracked_mutex(const tracked_mutex&) = delete;
+			tracked_mutex& operator=(const tracked_mutex&) = delete;
+
+			void lock() { mutex.lock(); }
+			void lock(const lock_site&) { mutex.lock(); }
+			bool try_lock() { return mutex.try_lock(); }
+			void unlock() { mutex.unlock(); }
+		private:
+			std::mutex mutex;
 		};
 
-		inline int fetch_event_t_id() {
-			if (thread_id == nullptr || *thread_id == -1) {
-				std::scoped_lock lock(store::event_mutex);
+		class tracked_shared_mutex {
+		public:
+			explicit tracked_shared_mutex(const char* = nullptr, int = 0, const char* = nullptr) {}
+			tracked_shared_mutex(const tracked_shared_mutex&) = delete;
+			tracked_shared_mutex& operator=(const tracked_shared_mutex&) = delete;
+
+			void lock() { mutex.lock(); }
+			void lock(const lock_site&) { mutex.lock(); }
+			bool try_lock() { return mutex.try_lock(); }
+			void unlock() { mutex.unlock(); }
+
+			void lock_shared() { mutex.lock_shared(); }
+			void lock_shared(const lock_site&) { mutex.lock_shared(); }
+			bool try_lock_shared() { return mutex.try_lock_shared(); }
+			void unlock_shared() { mutex.unlock_shared(); }
+		private:
+			std::shared_mutex mutex;
+		};
+#endif
 
-				if (thread_id == nullptr) {
-					store::a_thread_ids.emplace_back(++store::thread_cnt);
-					thread_id = &store::a_thread_ids[store::a_thread_ids.size() - 1];
-				}
-				else {
-					*thread_id = ++store::thread_cnt;
-				}
+		//scope of CTRACK_LOCK / CTRACK_LOCK_SHARED, locks with the caller as the lock_site
+		template<typename Mutex, bool Shared>
+		class tracked_lock_guard {
+		public:
+			tracked_lock_guard(Mutex& m, int line, const char* filename, const char* function) : mutex(m) {
+				if constexpr (Shared)
+					mutex.lock_shared(lock_site{ filename, function, line });
+				else
+					mutex.lock(lock_site{ filename, function, line });
+			}
+			~tracked_lock_guard() {
+				if constexpr (Shared)
+					mutex.unlock_shared();
+				else
+					mutex.unlock();
+			}
+			tracked_lock_guard(const tracked_lock_guard&) = delete;
+			tracked_lock_guard& operator=(const tracked_lock_guard&) = delete;
+		private:
+			Mutex& mutex;
+		};
 
-				store::a_events.emplace_back(t_events{});
-				store::a_sub_events.emplace_back(sub_events{});
-				store::a_current_event_id.emplace_back(0);
-				store::a_current_event_cnt.emplace_back(0);
-				store::a_string_id.emplace_back(0);
+		//attaches a size argument to the innermost span of the calling thread, or to the running CTRACK_CORO span at the top level of its body
+		inline void span_arg_mark(double value) {
+			const alloc_pause pause{};
+			while (store::write_events_locked) {}
+			const int t_id = fetch_event_t_id();
+			uint_fast64_t event_uid = 0;
+			if (*current_event_id != 0)
+				event_uid = get_unique_event_id(t_id, *current_event_id);
+			else if (running_coroutine.parent_id != 0 && running_coroutine.store_clear_cnt == store::store_clear_cnt)
+				event_uid = running_coroutine.parent_id;
+			else
+				return;
+			if (span_args_ptr->capacity() - span_args_ptr->size() < 1) span_args_ptr->reserve(std::max<size_t>(100, span_args_ptr->capacity() * 4));
+			span_args_ptr->push_back(span_arg{ event_uid, value });
+		}
 
-				event_ptr = &store::a_events[*thread_id];
-				sub_events_ptr = &store::a_sub_events[*thread_id];
+		//item count of the batch span just opened by CTRACK_BATCH
+		inline void batch_mark(uint_fast64_t items) {
+			const alloc_pause pause{};
+			if (batch_counts_ptr->capacity() - batch_counts_ptr->size() < 1) batch_counts_ptr->reserve(std::max<size_t>(100, batch_counts_ptr->capacity() * 4));
+			batch_counts_ptr->push_back(batch_count{ *current_event_id, items });
+		}
 
-				current_event_id = &store::a_current_event_id[*thread_id];
-				current_event_cnt = &store::a_current_event_cnt[*thread_id];
-				string_id = &store::a_string_id[*thread_id];
+		//span opened by CTRACK_BATCH, records the item count right after the span is registered
+		class batch_scope : public EventHandler {
+		public:
+			batch_scope(int line, const char* filename, const char* function, std::chrono::high_resolution_clock::time_point start_time, uint_fast64_t items)
+				: EventHandler(line, filename, function, start_time, event_kind::batch) {
+				batch_mark(items);
+			}
+		};
 
-				event_ptr->reserve(100);
+		//records the span on the calling thread, it does not become the parent of spans that are open on this thread
+		inline void end(span_token& token) {
+			if (!token.active)
+				return;
+			token.active = false;
+			auto end_time = std::chrono::high_resolution_clock::now();
+			const alloc_pause pause{};
+			while (store::write_events_locked) {}
+
+			const int t_id = fetch_event_t_id();
+			const unsigned int event_id = ++(*current_event_cnt);
+			if (event_ptr->capacity() - event_ptr->size() < 1) event_ptr->reserve(event_ptr->capacity() * 4);
+			event_ptr->emplace_back(Event{ token.start_time,end_time,token.filename,token.line,token.function,t_id ,event_id });
+			if (token.parent.parent_id != 0 && token.parent.store_clear_cnt == store::store_clear_cnt && token.store_clear_cnt == store::store_clear_cnt) {
+				span_links_ptr->push_back(span_link{ token.parent.parent_id, get_unique_event_id(t_id, event_id) });
 			}
-			return *thread_id;
+#ifdef CTRACK_ENABLE_CAUSAL
+			causal_span_end(token.filename, token.function, token.line, std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - token.start_time).count());
+#endif
 		}
 
-		class EventHandler {
+#ifdef CTRACK_HAS_COROUTINES
+		//state of a CTRACK_CORO span, lives in the coroutine promise. While the coroutine runs, spans of the running thread
+		//become cross thread children of it, while it is suspended the thread state it replaced is restored
+		class coroutine_span_state {
 		public:
-			EventHandler(int line = __builtin_LINE(), const char* filename = __builtin_FILE(), const char* function = __builtin_FUNCTION(), std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now()) : line(line)
-
-			{
-				this->start_time = start_time;
-				previous_store_clear_cnt = store::store_clear_cnt;
+			void start(int line, const char* filename, const char* function) {
+				const alloc_pause pause{};
+				while (store::write_events_locked) {}
+				this->line = line;
 				this->filename = filename;
 				this->function = function;
-				while (store::write_events_locked) {}
+				parent = mark_fork();
+				t_id = fetch_event_t_id();
+				event_id = ++(*current_event_cnt);
+				store_clear_cnt = store::store_clear_cnt;
+				start_time = std::chrono::high_resolution_clock::now();
+				active_time = 0;
+				suspensions = 0;
+				started = true;
+				enter(start_time);
+			}
 
-				register_event();
+			void suspend() {
+				if (!running)
+					return;
+				leave(std::chrono::high_resolution_clock::now());
+				suspensions++;
 			}
-			~EventHandler() {
+
+			void resume() {
+				if (started && !running)
+					enter(std::chrono::high_resolution_clock::now());
+			}
+
+			void finish() {
+				if (!started)
+					return;
+				started = false;
 				auto end_time = std::chrono::high_resolution_clock::now();
+				if (running)
+					leave(end_time);
+				const alloc_pause pause{};
 				while (store::write_events_locked) {}
 
-				if (store::store_clear_cnt != previous_store_clear_cnt)
-				{
-					register_event();
+				fetch_event_t_id();
+				if (store_clear_cnt != store::store_clear_cnt)
+					return;
+				const uint_fast64_t uid = get_unique_event_id(t_id, event_id);
+				if (event_ptr->capacity() - event_ptr->size() < 1) event_ptr->reserve(event_ptr->capacity() * 4);
+				event_ptr->emplace_back(Event{ start_time,end_time,filename,line,function,t_id ,event_id, event_kind::coroutine });
+				coroutine_records_ptr->push_back(coroutine_record{ uid, active_time, suspensions });
+				if (parent.parent_id != 0 && parent.store_clear_cnt == store::store_clear_cnt) {
+					span_links_ptr->push_back(span_link{ parent.parent_id, uid });
 				}
+#ifdef CTRACK_ENABLE_CAUSAL
+				causal_span_end(filename, function, line, active_time);
+#endif
+			}
+
+			bool is_running() const { return running; }
+		private:
+			void enter(std::chrono::high_resolution_clock::time_point now) {
+				const alloc_pause pause{};
+				fetch_event_t_id();
+				saved_event_id = *current_event_id;
+				saved_linked_parent = linked_parent;
+				saved_running_coroutine = running_coroutine;
+				*current_event_id = 0;
+				linked_parent = fork_point{ get_unique_event_id(t_id, event_id), store_clear_cnt };
+				running_coroutine = linked_parent;
+				enter_time = now;
+				running = true;
+			}
 
+			void leave(std::chrono::high_resolution_clock::time_point now) {
+				active_time += std::chrono::duration_cast<std::chrono::nanoseconds>(now - enter_time).count();
+				*current_event_id = saved_event_id;
+				linked_parent = saved_linked_parent;
+				running_coroutine = saved_running_coroutine;
+				running = false;
+			}
 
-				if (event_ptr->capacity() - event_ptr->size() < 1) event_ptr->reserve(event_ptr->capacity() * 4);
+			std::chrono::high_resolution_clock::time_point start_time{}, enter_time{};
+			std::string_view filename{}, function{};
+			int line = 0;
+			int t_id = 0;
+			unsigned int event_id = 0;
+			unsigned int store_clear_cnt = 0;
+			fork_point parent{}, saved_linked_parent{}, saved_running_coroutine{};
+			unsigned int saved_event_id = 0;
+			uint_fast64_t active_time = 0;
+			unsigned int suspensions = 0;
+			bool started = false, running = false;
+		};
 
-				event_ptr->emplace_back(Event{ start_time,end_time,filename,line,function,t_id ,event_id });
+		struct coroutine_span_state_request {};
 
-				*current_event_id = previous_event_id;
-				if (previous_event_id > 0) {
-					if ((*sub_events_ptr)[previous_event_id].capacity() - (*sub_events_ptr)[previous_event_id].size() < 1) (*sub_events_ptr)[previous_event_id].reserve((*sub_events_ptr)[previous_event_id].capacity() * 4);
-					(*sub_events_ptr)[previous_event_id].push_back(event_id);
+		template<typename Awaitable>
+		decltype(auto) coroutine_get_awaiter(Awaitable&& awaitable) {
+			if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); })
+				return std::forward<Awaitable>(awaitable).operator co_await();
+			else if constexpr (requires { operator co_await(std::forward<Awaitable>(awaitable)); })
+				return operator co_await(std::forward<Awaitable>(awaitable));
+			else
+				return std::forward<Awaitable>(awaitable);
+		}
+
+		//suspends the span before handing the coroutine to the wrapped awaiter and resumes it on the resuming thread
+		template<typename Awaitable>
+		class coroutine_awaiter {
+			using awaiter_ref = decltype(coroutine_get_awaiter(std::declval<Awaitable>()));
+			using awaiter_type = std::conditional_t<std::is_rvalue_reference_v<awaiter_ref>, std::remove_reference_t<awaiter_ref>, awaiter_ref>;
+		public:
+			coroutine_awaiter(coroutine_span_state& state, Awaitable&& awaitable)
+				: state(state), awaiter(coroutine_get_awaiter(std::forward<Awaitable>(awaitable))) {}
+
+			bool await_ready() { return awaiter.await_ready(); }
+
+			template<typename Promise>
+			decltype(auto) await_suspend(std::coroutine_handle<Promise> handle) {
+				//the coroutine may be resumed on another thread before the wrapped await_suspend returns
+				state.suspend();
+				try {
+					return awaiter.await_suspend(handle);
 				}
+				catch (...) {
+					state.resume();
+					throw;
+				}
+			}
+
+			decltype(auto) await_resume() {
+				state.resume();
+				return awaiter.await_resume();
 			}
 		private:
-			void register_event() {
-				t_id = fetch_event_t_id();
-				previous_event_id = *current_event_id;
-				event_id = ++(*current_event_cnt);
-				*current_event_id = event_id;
+			coroutine_span_state& state;
+			awaiter_type awaiter;
+		};
+
+		//promise mix-in: derive the promise_type from it and put CTRACK_CORO at the top of the coroutine body.
+		//Promises with their own await_transform forward the awaitables through ctrack::coroutine_await
+		class coroutine_promise {
+		public:
+			auto await_transform(coroutine_span_state_request) noexcept {
+				struct state_awaiter {
+					coroutine_span_state& state;
+					bool await_ready() const noexcept { return true; }
+					void await_suspend(std::coroutine_handle<>) const noexcept {}
+					coroutine_span_state& await_resume() const noexcept { return state; }
+				};
+				return state_awaiter{ ctrack_span_state };
 			}
-			std::chrono::high_resolution_clock::time_point start_time;
-			int line;
-			unsigned int previous_store_clear_cnt;
 
-			std::string_view filename, function;
+			template<typename Awaitable>
+			auto await_transform(Awaitable&& awaitable) {
+				return coroutine_awaiter<Awaitable>{ ctrack_span_state, std::forward<Awaitable>(awaitable) };
+			}
 
-			int t_id;
-			unsigned int event_id;
-			unsigned int previous_event_id;
+			coroutine_span_state ctrack_span_state{};
+		};
+
+		template<typename Awaitable>
+		auto coroutine_await(coroutine_span_state& state, Awaitable&& awaitable) {
+			return coroutine_awaiter<Awaitable>{ state, std::forward<Awaitable>(awaitable) };
+		}
+
+		class coroutine_span {
+		public:
+			coroutine_span(coroutine_span_state& state, int line, const char* filename, const char* function) : state(state) {
+				state.start(line, filename, function);
+			}
+			~coroutine_span() {
+				state.finish();
+			}
+			coroutine_span(const coroutine_span&) = delete;
+			coroutine_span& operator=(const coroutine_span&) = delete;
+		private:
+			coroutine_span_state& state;
 		};
+#endif
 
 		inline void clear_a_store() {
 			store::a_current_event_id.clear();
@@ -880,6 +4680,27 @@ namespace ctrack {
 			store::a_sub_events.clear();
 			store::a_sub_events.shrink_to_fit();
 
+			store::a_span_links.clear();
+			store::a_span_links.shrink_to_fit();
+
+			store::a_coroutine_records.clear();
+			store::a_coroutine_records.shrink_to_fit();
+
+			store::a_queue_events.clear();
+			store::a_queue_events.shrink_to_fit();
+
+			store::a_metric_records.clear();
+			store::a_metric_records.shrink_to_fit();
+
+			store::a_span_args.clear();
+			store::a_span_args.shrink_to_fit();
+
+			store::a_batch_counts.clear();
+			store::a_batch_counts.shrink_to_fit();
+
+			store::a_lock_events.clear();
+			store::a_lock_events.shrink_to_fit();
+
 			store::thread_cnt = -1;
 			for (auto& entry : store::a_thread_ids)
 			{
@@ -906,6 +4727,13 @@ namespace ctrack {
 					auto& t_events_entry = store::a_events[thread_id_];
 					auto& t_sub_events = store::a_sub_events[thread_id_];
 					res.add_sub_events(t_sub_events, thread_id_);
+					res.add_span_links(store::a_span_links[thread_id_]);
+					res.add_coroutine_records(store::a_coroutine_records[thread_id_]);
+					res.add_queue_events(store::a_queue_events[thread_id_]);
+					res.add_metric_records(store::a_metric_records[thread_id_]);
+					res.add_span_args(store::a_span_args[thread_id_]);
+					res.add_batch_counts(store::a_batch_counts[thread_id_], thread_id_);
+					res.add_lock_events(store::a_lock_events[thread_id_]);
 
 					for (const auto& c_event : t_events_entry)
 					{
@@ -924,10 +4752,258 @@ namespace ctrack {
 			return res;
 		}
 
+#ifdef CTRACK_ENABLE_CAUSAL
+		struct causal_callsite {
+			std::string filename = {};
+			std::string function_name = {};
+			int line = 0;
+		};
+
+		struct causal_settings {
+			std::vector<causal_callsite> callsites = {}; //candidates, see causal_callsites()
+			std::vector<double> speedups = { 10.0, 20.0, 30.0, 40.0, 50.0 }; //virtual speedups in percent, baseline experiments are added
+			std::string progress_point = {}; //empty sums all progress points
+			std::chrono::milliseconds experiment_duration{ 50 };
+			std::chrono::milliseconds cooldown{ 5 };
+		};
+
+		struct causal_point {
+			double speedup = 0.0; //virtual speedup of the callsite in percent
+			double program_speedup = 0.0; //predicted progress rate change in percent
+			unsigned int experiments = 0;
+			uint_fast64_t progress = 0;
+		};
+
+		struct causal_curve {
+			causal_callsite callsite{};
+			std::vector<causal_point> points = {};
+		};
+
+		class causal_result {
+		public:
+			template<typename StreamType>
+			void get_causal_table(StreamType& stream, bool use_color = false) const {
+				std::vector<std::string> header{ "filename", "function", "line" };
+				for (double speedup : speedups)
+					header.push_back("+" + BeautifulTable::table_string(speedup) + "%");
+				BeautifulTable table(header, use_color, default_colors,
+					{ {"callsite",3},{"predicted program speedup at virtual callsite speedup",static_cast<int>(speedups.size())} });
+				for (const auto& curve : curves) {
+					std::vector<std::string> row{ BeautifulTable::stable_shortenPath(curve.callsite.filename), curve.callsite.function_name,
+						BeautifulTable::table_string(curve.callsite.line) };
+					for (const auto& point : curve.points) {
+						std::ostringstream ss;
+						if (point.experiments == 0)
+							ss << "-";
+						else
+							ss << std::showpos << std::fixed << std::setprecision(1) << point.program_speedup << "%";
+						row.push_back(ss.str());
+					}
+					table.addRow(row);
+				}
+				BeautifulTable info({ "experiments", "baseline experiments", "baseline progress/s" }, use_color, default_colors);
+				info.addRow({ BeautifulTable::table_string(experiments), BeautifulTable::table_string(baseline_experiments),
+					BeautifulTable::table_string(baseline_rate * 1e9) });
+				info.print(stream);
+				table.print(stream);
+			}
+
+			std::vector<double> speedups = {};
+			std::vector<causal_curve> curves = {}; //sorted by largest predicted program speedup
+			double baseline_rate = 0.0; //progress per ns without virtual speedup
+			unsigned int experiments = 0;
+			unsigned int baseline_experiments = 0;
+		};
+
+		//top callsites by time active exclusive as causal candidates
+		inline std::vector<causal_callsite> causal_callsites(const ctrack_result& res, size_t max_callsites = 10) {
+			std::vector<causal_callsite> callsites{};
+			for (size_t i = 0; i < res.sorted_events.size() && i < max_callsites; i++)
+				callsites.push_back({ res.sorted_events[i]->filename, res.sorted_events[i]->function_name, res.sorted_events[i]->line });
+			return callsites;
+		}
+
+		struct causal_measurement {
+			uint_fast64_t progress = 0;
+			uint_fast64_t effective_time = 0; //elapsed ns minus the inserted pauses
+			unsigned int experiments = 0;
+		};
+
+		struct causal_controller {
+			inline static std::mutex mutex;
+			inline static std::thread thread;
+			inline static std::atomic<bool> running{ false };
+			inline static causal_settings settings{};
+			inline static causal_result result{};
+			//per callsite and speedup, the last callsite slot holds the baselines
+			inline static std::vector<std::vector<causal_measurement>> measurements{};
+		};
+
+		inline uint_fast64_t causal_progress(const std::string& progress_point) {
+			std::scoped_lock lock(causal_store::progress_mutex);
+			uint_fast64_t sum = 0;
+			for (const auto& entry : causal_store::progress_points) {
+				if (progress_point.empty() || entry.name == progress_point)
+					sum += entry.cnt.load(std::memory_order_relaxed);
+			}
+			return sum;
+		}
+
+		inline void causal_run() {
+			const auto& settings = causal_controller::settings;
+			const size_t callsite_cnt = settings.callsites.size();
+			std::vector<std::pair<size_t, size_t>> schedule{}; //callsite, speedup index; callsite_cnt marks a baseline
+			std::mt19937 gen(static_cast<unsigned int>(callsite_cnt * 31 + settings.speedups.size()));
+			while (causal_controller::running) {
+				if (schedule.empty()) {
+					for (size_t c = 0; c < callsite_cnt; c++)
+						for (size_t v = 0; v < settings.speedups.size(); v++)
+							schedule.emplace_back(c, v);
+					const size_t baselines = std::max<size_t>(schedule.size() / 2, 1);
+					for (size_t b = 0; b < baselines; b++)
+						schedule.emplace_back(callsite_cnt, 0);
+					std::shuffle(schedule.begin(), schedule.end(), gen);
+				}
+				const auto [callsite, speedup] = schedule.back();
+				schedule.pop_back();
+
+				const uint_fast64_t progress_start = causal_progress(settings.progress_point);
+				const uint_fast64_t delay_start = causal_store::global_delay;
+				const auto start = std::chrono::high_resolution_clock::now();
+				if (callsite < callsite_cnt) {
+					causal_store::speedup = settings.speedups[speedup] / 100.0;
+					causal_store::selected_filename.store(&settings.callsites[callsite].filename, std::memory_order_release);
+					causal_store::selected_function.store(&settings.callsites[callsite].function_name, std::memory_order_release);
+					causal_store::selected_line = settings.callsites[callsite].line;
+				}
+				std::this_thread::sleep_for(settings.experiment_duration);
+				causal_store::selected_line = -1;
+				const auto end = std::chrono::high_resolution_clock::now();
+				const uint_fast64_t progress = causal_progress(settings.progress_point) - progress_start;
+				const uint_fast64_t delay = causal_store::global_delay - delay_start;
+				const uint_fast64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+				if (elapsed > delay) {
+					std::scoped_lock lock(causal_controller::mutex);
+					auto& m = causal_controller::measurements[callsite][callsite < callsite_cnt ? speedup : 0];
+					m.progress += progress;
+					m.effective_time += elapsed - delay;
+					m.experiments++;
+					if (callsite < callsite_cnt)
+						causal_controller::result.experiments++;
+					else
+						causal_controller::result.baseline_experiments++;
+				}
+				std::this_thread::sleep_for(settings.cooldown);
+			}
+		}
+
+		//starts a background thread that runs virtual speedup experiments until causal_stop()
+		inline void causal_start(const causal_settings& settings) {
+			if (causal_controller::running.exchange(true))
+				return;
+			causal_controller::settings = settings;
+			causal_controller::result = {};
+			causal_controller::measurements.assign(settings.callsites.size() + 1,
+				std::vector<causal_measurement>(std::max<size_t>(settings.speedups.size(), 1)));
+			causal_controller::thread = std::thread(causal_run);
+		}
+
+		inline causal_result causal_stop() {
+			if (!causal_controller::running.exchange(false))
+				return {};
+			causal_controller::thread.join();
+
+			std::scoped_lock lock(causal_controller::mutex);
+			const auto& settings = causal_controller::settings;
+			causal_result res = causal_controller::result;
+			res.speedups = settings.speedups;
+			const auto& baseline = causal_controller::measurements.back()[0];
+			res.baseline_rate = baseline.effective_time > 0 ? static_cast<double>(baseline.progress) / baseline.effective_time : 0.0;
+			for (size_t c = 0; c < settings.callsites.size(); c++) {
+				causal_curve curve{ settings.callsites[c], {} };
+				for (size_t v = 0; v < settings.speedups.size(); v++) {
+					const auto& m = causal_controller::measurements[c][v];
+					causal_point point{ settings.speedups[v], 0.0, m.experiments, m.progress };
+					if (m.effective_time > 0 && res.baseline_rate > 0.0)
+						point.program_speedup = (static_cast<double>(m.progress) / m.effective_time / res.baseline_rate - 1.0) * 100.0;
+					curve.points.push_back(point);
+				}
+				res.curves.push_back(curve);
+			}
+			auto max_speedup = [](const causal_curve& curve) {
+				double res = -std::numeric_limits<double>::infinity();
+				for (const auto& point : curve.points)
+					if (point.experiments > 0)
+						res = std::max(res, point.program_speedup);
+				return res;
+				};
+			std::sort(res.curves.begin(), res.curves.end(), [&](const causal_curve& a, const causal_curve& b) { return max_speedup(a) > max_speedup(b); });
+			return res;
+		}
+#endif
+
 		inline void result_print(ctrack_result_settings settings = {}) {
 			auto res = calc_stats_and_clear(settings);
 			std::cout << "Details" << std::endl;
 			res.get_detail_table(std::cout, true);
+			if (res.wait_events.size() > 0) {
+				std::cout << "Waits" << std::endl;
+				res.get_wait_table(std::cout, true);
+			}
+			if (settings.heatmap_time_buckets > 0) {
+				std::cout << "Heatmaps" << std::endl;
+				res.get_heatmap(std::cout, true);
+			}
+			if (settings.critical_path) {
+				std::cout << "Critical Path" << std::endl;
+				res.get_critical_path_table(std::cout, true);
+			}
+			if (settings.amdahl_analysis) {
+				std::cout << "Concurrency" << std::endl;
+				res.get_amdahl_table(std::cout, true);
+			}
+			if (settings.overlap_top_n > 0) {
+				std::cout << "Overlap" << std::endl;
+				res.get_overlap_table(std::cout, true);
+			}
+			if (res.frames.size() > 0) {
+				std::cout << "Frames" << std::endl;
+				res.get_frame_table(std::cout, true);
+			}
+			if (res.parallel_regions.size() > 0) {
+				std::cout << "Parallel Regions" << std::endl;
+				res.get_parallel_region_table(std::cout, true);
+			}
+			if (res.coroutines.size() > 0) {
+				std::cout << "Coroutines" << std::endl;
+				res.get_coroutine_table(std::cout, true);
+			}
+			if (res.batches.size() > 0) {
+				std::cout << "Batches" << std::endl;
+				res.get_batch_table(std::cout, true);
+			}
+			if (res.locks.size() > 0) {
+				std::cout << "Locks" << std::endl;
+				res.get_lock_table(std::cout, true);
+			}
+			if (res.queues.size() > 0) {
+				std::cout << "Queues" << std::endl;
+				res.get_queue_table(std::cout, true);
+			}
+			if (res.counters.size() > 0) {
+				std::cout << "Counters" << std::endl;
+				res.get_counter_table(std::cout, true);
+			}
+			if (res.gauges.size() > 0) {
+				std::cout << "Gauges" << std::endl;
+				res.get_gauge_table(std::cout, true);
+			}
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			if (res.migrated_spans.size() > 0) {
+				std::cout << "Migrations" << std::endl;
+				res.get_migration_table(std::cout, true);
+			}
+#endif
 			std::cout << "Summary" << std::endl;
 			res.get_summary_table(std::cout, true);
 		}
@@ -939,20 +5015,101 @@ namespace ctrack {
 			res.get_summary_table(ss, false);
 			ss << "Details\n";
 			res.get_detail_table(ss, false, true);
+			if (res.wait_events.size() > 0) {
+				ss << "Waits\n";
+				res.get_wait_table(ss, false);
+			}
+			if (settings.heatmap_time_buckets > 0) {
+				ss << "Heatmaps\n";
+				res.get_heatmap(ss, false);
+			}
+			if (settings.critical_path) {
+				ss << "Critical Path\n";
+				res.get_critical_path_table(ss, false);
+			}
+			if (settings.amdahl_analysis) {
+				ss << "Concurrency\n";
+				res.get_amdahl_table(ss, false);
+			}
+			if (settings.overlap_top_n > 0) {
+				ss << "Overlap\n";
+				res.get_overlap_table(ss, false);
+			}
+			if (res.frames.size() > 0) {
+				ss << "Frames\n";
+				res.get_frame_table(ss, false);
+			}
+			if (res.parallel_regions.size() > 0) {
+				ss << "Parallel Regions\n";
+				res.get_parallel_region_table(ss, false);
+			}
+			if (res.coroutines.size() > 0) {
+				ss << "Coroutines\n";
+				res.get_coroutine_table(ss, false);
+			}
+			if (res.batches.size() > 0) {
+				ss << "Batches\n";
+				res.get_batch_table(ss, false);
+			}
+			if (res.locks.size() > 0) {
+				ss << "Locks\n";
+				res.get_lock_table(ss, false);
+			}
+			if (res.queues.size() > 0) {
+				ss << "Queues\n";
+				res.get_queue_table(ss, false);
+			}
+			if (res.counters.size() > 0) {
+				ss << "Counters\n";
+				res.get_counter_table(ss, false);
+			}
+			if (res.gauges.size() > 0) {
+				ss << "Gauges\n";
+				res.get_gauge_table(ss, false);
+			}
+#ifdef CTRACK_ENABLE_CPU_TRACKING
+			if (res.migrated_spans.size() > 0) {
+				ss << "Migrations\n";
+				res.get_migration_table(ss, false);
+			}
+#endif
 
 			return ss.str();
 		}
 	}
 }
 
-#ifndef CTRACK_DISABLE
 #define CTRACK_CONCAT_IMPL(x, y) x ## y
 #define CTRACK_CONCAT(x, y) CTRACK_CONCAT_IMPL(x, y)
 #define CTRACK_UNIQUE_NAME(prefix) CTRACK_CONCAT(prefix, __COUNTER__)
 
+#ifndef CTRACK_DISABLE
 
 #define CTRACK_IMPL ctrack::EventHandler CTRACK_UNIQUE_NAME(ctrack_instance_){__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION()}
 #define CTRACK_IMPL_NAME(name) ctrack::EventHandler CTRACK_UNIQUE_NAME(ctrack_instance_){__builtin_LINE(),__builtin_FILE(),name}
+#define CTRACK_FORKED(fork_point) ctrack::forked_scope CTRACK_UNIQUE_NAME(ctrack_forked_){fork_point}
+#ifdef CTRACK_HAS_COROUTINES
+#define CTRACK_CORO ctrack::coroutine_span CTRACK_UNIQUE_NAME(ctrack_coro_){co_await ctrack::coroutine_span_state_request{},__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION()}
+#endif
+#define CTRACK_ENQUEUE(queue, id) ctrack::queue_mark(queue, ctrack::queue_item_id(id), false)
+#define CTRACK_DEQUEUE(queue, id) ctrack::queue_mark(queue, ctrack::queue_item_id(id), true)
+#define CTRACK_COUNT(name, value) ctrack::metric_mark(name, static_cast<double>(value), false)
+#define CTRACK_GAUGE(name, value) ctrack::metric_mark(name, static_cast<double>(value), true)
+#define CTRACK_FRAME(name) ctrack::EventHandler CTRACK_UNIQUE_NAME(ctrack_frame_){__builtin_LINE(),__builtin_FILE(),name,std::chrono::high_resolution_clock::now(),ctrack::event_kind::frame}
+#define CTRACK_WAIT ctrack::EventHandler CTRACK_UNIQUE_NAME(ctrack_wait_){__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION(),std::chrono::high_resolution_clock::now(),ctrack::event_kind::wait}
+#define CTRACK_WAIT_NAME(name) ctrack::EventHandler CTRACK_UNIQUE_NAME(ctrack_wait_){__builtin_LINE(),__builtin_FILE(),name,std::chrono::high_resolution_clock::now(),ctrack::event_kind::wait}
+#define CTRACK_ARG(n) ctrack::span_arg_mark(static_cast<double>(n))
+#define CTRACK_BATCH(count) ctrack::batch_scope CTRACK_UNIQUE_NAME(ctrack_batch_){__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION(),std::chrono::high_resolution_clock::now(),static_cast<uint_fast64_t>(count)}
+#define CTRACK_PARALLEL_REGION(var, name) ctrack::parallel_region_scope var{__builtin_LINE(),__builtin_FILE(),name,std::chrono::high_resolution_clock::now()}
+#define CTRACK_LOCK(mutex) ctrack::tracked_lock_guard<std::remove_reference_t<decltype(mutex)>, false> CTRACK_UNIQUE_NAME(ctrack_lock_){mutex,__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION()}
+#define CTRACK_LOCK_SHARED(mutex) ctrack::tracked_lock_guard<std::remove_reference_t<decltype(mutex)>, true> CTRACK_UNIQUE_NAME(ctrack_lock_){mutex,__builtin_LINE(),__builtin_FILE(),__builtin_FUNCTION()}
+#ifdef CTRACK_ENABLE_CAUSAL
+#define CTRACK_PROGRESS(name) do { static auto& ctrack_progress_counter_ = ctrack::progress_counter(name); ctrack_progress_counter_.fetch_add(1, std::memory_order_relaxed); ctrack::causal_sync(); } while (0)
+#define CTRACK_CAUSAL_BLOCKED ctrack::causal_blocked_scope CTRACK_UNIQUE_NAME(ctrack_causal_blocked_){}
+#else
+#define CTRACK_PROGRESS(name)
+#define CTRACK_CAUSAL_BLOCKED
+#endif
 #if defined(CTRACK_DISABLE_DEV)
 #define CTRACK_PROD CTRACK_IMPL
 #define CTRACK_PROD_NAME(name) CTRACK_IMPL_NAME(name)
@@ -981,6 +5138,107 @@ namespace ctrack {
 #define CTRACK_DEV_NAME(name)
 #define CTRACK
 #define CTRACK_NAME(name)
+#define CTRACK_FORKED(fork_point) (void)(fork_point)
+#define CTRACK_PARALLEL_REGION(var, name) const ctrack::fork_point var{}
+#ifdef CTRACK_HAS_COROUTINES
+#define CTRACK_CORO
+#endif
+#define CTRACK_FRAME(name)
+#define CTRACK_WAIT
+#define CTRACK_WAIT_NAME(name)
+#define CTRACK_ARG(n)
+#define CTRACK_BATCH(count)
+#define CTRACK_LOCK(mutex) std::lock_guard CTRACK_UNIQUE_NAME(ctrack_lock_){mutex}
+#define CTRACK_LOCK_SHARED(mutex) std::shared_lock CTRACK_UNIQUE_NAME(ctrack_lock_){mutex}
+#define CTRACK_COUNT(name, value)
+#define CTRACK_GAUGE(name, value)
+#define CTRACK_ENQUEUE(queue, id)
+#define CTRACK_DEQUEUE(queue, id)
+#define CTRACK_PROGRESS(name)
+#define CTRACK_CAUSAL_BLOCKED
 #endif // CTRACK_DISABLE
 
+// Define CTRACK_ALLOC_HOOK_IMPLEMENTATION in exactly one translation unit to replace the global operator new/delete
+// with versions that feed the per thread allocation counters.
+#if defined(CTRACK_ENABLE_ALLOC_TRACKING) && defined(CTRACK_ALLOC_HOOK_IMPLEMENTATION)
+namespace ctrack { inline namespace CTRACK_VERSION_NAMESPACE { namespace alloc_hook {
+	//like the standard operator new: calls the new_handler until the allocation succeeds, throws bad_alloc without one
+	template<typename Allocate>
+	inline void* allocate_or_throw(Allocate allocate) {
+		for (;;) {
+			if (void* ptr = allocate())
+				return ptr;
+			const std::new_handler handler = std::get_new_handler();
+			if (handler == nullptr)
+				throw std::bad_alloc{};
+			handler();
+		}
+	}
+	inline void* allocate(std::size_t size) {
+		ctrack::count_allocation(size);
+		return allocate_or_throw([size]() noexcept { return std::malloc(size == 0 ? 1 : size); });
+	}
+	inline void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+		ctrack::count_allocation(size);
+		const std::size_t align = static_cast<std::size_t>(alignment);
+		const std::size_t rounded = (size == 0 ? align : (size + align - 1) / align * align);
+		return allocate_or_throw([align, rounded]() noexcept {
+#ifdef _WIN32
+			return _aligned_malloc(rounded, align);
+#else
+			return std::aligned_alloc(align, rounded);
+#endif
+			});
+	}
+	inline void deallocate_aligned(void* ptr) noexcept {
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+} } }
+
+void* operator new(std::size_t size) { return ctrack::alloc_hook::allocate(size); }
+void* operator new[](std::size_t size) { return ctrack::alloc_hook::allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try { return ctrack::alloc_hook::allocate(size); }
+	catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	try { return ctrack::alloc_hook::allocate(size); }
+	catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) { return ctrack::alloc_hook::allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return ctrack::alloc_hook::allocate_aligned(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	try { return ctrack::alloc_hook::allocate_aligned(size, alignment); }
+	catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	try { return ctrack::alloc_hook::allocate_aligned(size, alignment); }
+	catch (...) { return nullptr; }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" //operator new above allocates with malloc
+#endif
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { ctrack::alloc_hook::deallocate_aligned(ptr); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif // CTRACK_ALLOC_HOOK_IMPLEMENTATION
+
 #endif
\ No newline at end of file